@@ -4,6 +4,8 @@
 
 #include "audio_player.h"
 
+#include <algorithm>
+
 #include "audio_player_error.h"
 #include "log.h"
 
@@ -21,8 +23,11 @@ AudioPlayer::AudioPlayer(const std::string &player_id,
                          DurationListener duration_listener,
                          SeekCompletedListener seek_completed_listener,
                          PlayCompletedListener play_completed_listener,
-                         LogListener log_listener)
+                         LogListener log_listener, SoundPool *sound_pool,
+                         PositionTicker *position_ticker)
     : player_id_(player_id),
+      sound_pool_(sound_pool),
+      position_ticker_(position_ticker),
       prepared_listener_(prepared_listener),
       duration_listener_(duration_listener),
       seek_completed_listener_(seek_completed_listener),
@@ -32,6 +37,7 @@ AudioPlayer::AudioPlayer(const std::string &player_id,
 }
 
 AudioPlayer::~AudioPlayer() {
+  StopVoices();
   if (player_) {
     player_unset_completed_cb(player_);
     player_unset_interrupted_cb(player_);
@@ -39,14 +45,29 @@ AudioPlayer::~AudioPlayer() {
     player_destroy(player_);
     player_ = nullptr;
   }
-  if (timer_id_ != 0) {
-    g_source_remove(timer_id_);
-    timer_id_ = 0;
-  }
+  position_ticker_->Remove(this);
   *is_alive_ = false;
 }
 
 void AudioPlayer::Play() {
+  if (sound_) {
+    if (sound_pool_->IsPaused(voice_id_)) {
+      for (int voice_id : voices_) {
+        sound_pool_->Resume(voice_id);
+      }
+    } else if (release_mode_ == ReleaseMode::kLoop &&
+               sound_pool_->IsPlaying(voice_id_)) {
+      // A looping sound is restarted rather than overlapped, as it would
+      // never end.
+      sound_pool_->Seek(voice_id_, 0);
+    } else {
+      // A sound that is still playing keeps playing, so that repeated
+      // effects overlap.
+      PlaySound();
+    }
+    return;
+  }
+
   player_state_e state = GetPlayerState();
   if (state == PLAYER_STATE_IDLE && preparing_) {
     // Player is preparing, play will be called in prepared callback.
@@ -57,9 +78,9 @@ void AudioPlayer::Play() {
   switch (state) {
     case PLAYER_STATE_NONE:
     case PLAYER_STATE_IDLE: {
-      if (audio_data_.size() > 0) {
-        int ret = player_set_memory_buffer(player_, audio_data_.data(),
-                                           audio_data_.size());
+      if (audio_data_ && !audio_data_->empty()) {
+        int ret = player_set_memory_buffer(player_, audio_data_->data(),
+                                           audio_data_->size());
         if (ret != PLAYER_ERROR_NONE) {
           throw AudioPlayerError("player_set_memory_buffer failed",
                                  get_error_message(ret));
@@ -94,7 +115,11 @@ void AudioPlayer::Play() {
 }
 
 void AudioPlayer::Pause() {
-  if (GetPlayerState() == PLAYER_STATE_PLAYING) {
+  if (sound_) {
+    for (int voice_id : voices_) {
+      sound_pool_->Pause(voice_id);
+    }
+  } else if (GetPlayerState() == PLAYER_STATE_PLAYING) {
     int ret = player_pause(player_);
     if (ret != PLAYER_ERROR_NONE) {
       throw AudioPlayerError("player_pause failed", get_error_message(ret));
@@ -105,11 +130,15 @@ void AudioPlayer::Pause() {
 }
 
 void AudioPlayer::Stop() {
-  player_state_e state = GetPlayerState();
-  if (state == PLAYER_STATE_PLAYING || state == PLAYER_STATE_PAUSED) {
-    int ret = player_stop(player_);
-    if (ret != PLAYER_ERROR_NONE) {
-      throw AudioPlayerError("player_stop failed", get_error_message(ret));
+  if (sound_) {
+    StopVoices();
+  } else {
+    player_state_e state = GetPlayerState();
+    if (state == PLAYER_STATE_PLAYING || state == PLAYER_STATE_PAUSED) {
+      int ret = player_stop(player_);
+      if (ret != PLAYER_ERROR_NONE) {
+        throw AudioPlayerError("player_stop failed", get_error_message(ret));
+      }
     }
   }
 
@@ -123,7 +152,8 @@ void AudioPlayer::Stop() {
 
 void AudioPlayer::ReleaseMediaSource() {
   url_.clear();
-  audio_data_.clear();
+  audio_data_.reset();
+  LoadSound();
   ResetPlayer();
 }
 
@@ -132,6 +162,16 @@ void AudioPlayer::Seek(int32_t position) {
     return;
   }
 
+  if (sound_) {
+    if (voice_id_ != 0) {
+      sound_pool_->Seek(voice_id_, position);
+    } else {
+      should_seek_to_ = position;
+    }
+    seek_completed_listener_(player_id_);
+    return;
+  }
+
   player_state_e state = GetPlayerState();
   if (state == PLAYER_STATE_READY || state == PLAYER_STATE_PLAYING ||
       state == PLAYER_STATE_PAUSED) {
@@ -157,7 +197,11 @@ void AudioPlayer::OnLog(const std::string &message) {
 
 void AudioPlayer::SetUrl(const std::string &url) {
   url_ = url;
+  audio_data_.reset();
   ResetPlayer();
+  if (LoadSound()) {
+    return;
+  }
 
   int ret = player_set_uri(player_, url.c_str());
   if (ret != PLAYER_ERROR_NONE) {
@@ -165,16 +209,21 @@ void AudioPlayer::SetUrl(const std::string &url) {
   }
 
   PreparePlayer();
-  audio_data_.clear();
 }
 
-void AudioPlayer::SetDataSource(std::vector<uint8_t> &data) {
-  if (data != audio_data_) {
-    audio_data_.swap(data);
+void AudioPlayer::SetDataSource(AudioBytes data,
+                                const std::string &cache_key) {
+  if (data != audio_data_ && (!audio_data_ || *data != *audio_data_)) {
+    audio_data_ = std::move(data);
+    audio_cache_key_ = cache_key;
+    url_.clear();
     ResetPlayer();
+    if (LoadSound()) {
+      return;
+    }
 
-    int ret = player_set_memory_buffer(player_, audio_data_.data(),
-                                       audio_data_.size());
+    int ret = player_set_memory_buffer(player_, audio_data_->data(),
+                                       audio_data_->size());
     if (ret != PLAYER_ERROR_NONE) {
       throw AudioPlayerError("player_set_memory_buffer failed",
                              get_error_message(ret));
@@ -192,6 +241,11 @@ void AudioPlayer::SetVolume(double volume) {
   }
   volume_ = volume;
 
+  if (sound_) {
+    for (int voice_id : voices_) {
+      sound_pool_->SetVolume(voice_id, volume_);
+    }
+  }
   if (GetPlayerState() != PLAYER_STATE_NONE) {
     int ret = player_set_volume(player_, volume_, volume_);
     if (ret != PLAYER_ERROR_NONE) {
@@ -205,6 +259,9 @@ void AudioPlayer::SetPlaybackRate(double playback_rate) {
   // TODO(seungsoo47): The player_set_playback_rate() API has a limitation of
   // 0.5-2x on TV and is not supported on RPI.
   playback_rate_ = playback_rate;
+  if (sound_ && playback_rate_ != 1.0) {
+    OnLog("Playback rate is not supported in the low latency mode.");
+  }
   player_state_e state = GetPlayerState();
   if (state == PLAYER_STATE_READY || state == PLAYER_STATE_PLAYING ||
       state == PLAYER_STATE_PAUSED) {
@@ -219,6 +276,11 @@ void AudioPlayer::SetPlaybackRate(double playback_rate) {
 void AudioPlayer::SetReleaseMode(ReleaseMode mode) {
   if (release_mode_ != mode) {
     release_mode_ = mode;
+    if (sound_) {
+      for (int voice_id : voices_) {
+        sound_pool_->SetLooping(voice_id, release_mode_ == ReleaseMode::kLoop);
+      }
+    }
     if (GetPlayerState() != PLAYER_STATE_NONE) {
       int ret =
           player_set_looping(player_, (release_mode_ == ReleaseMode::kLoop));
@@ -231,6 +293,23 @@ void AudioPlayer::SetReleaseMode(ReleaseMode mode) {
 }
 
 void AudioPlayer::SetLatencyMode(bool low_latency) {
+  if (low_latency_ != low_latency) {
+    low_latency_ = low_latency;
+    // Move the current source between the sound pool and the player.
+    if (low_latency_ && !sound_) {
+      if (LoadSound()) {
+        ResetPlayer();
+      }
+    } else if (!low_latency_ && sound_) {
+      LoadSound();
+      if (!url_.empty() || audio_data_) {
+        ResetPlayer();
+        SetPlayerSource();
+        PreparePlayer();
+      }
+    }
+  }
+
   int ret = player_set_audio_latency_mode(
       player_, low_latency ? AUDIO_LATENCY_MODE_LOW : AUDIO_LATENCY_MODE_MID);
   if (ret != PLAYER_ERROR_NONE) {
@@ -240,6 +319,9 @@ void AudioPlayer::SetLatencyMode(bool low_latency) {
 }
 
 int AudioPlayer::GetDuration() {
+  if (sound_) {
+    return sound_->duration();
+  }
   int32_t duration;
   int ret = player_get_duration(player_, &duration);
   if (ret != PLAYER_ERROR_NONE) {
@@ -250,6 +332,9 @@ int AudioPlayer::GetDuration() {
 }
 
 int AudioPlayer::GetCurrentPosition() {
+  if (sound_) {
+    return sound_pool_->GetPosition(voice_id_);
+  }
   int32_t position;
   int ret = player_get_play_position(player_, &position);
   if (ret != PLAYER_ERROR_NONE) {
@@ -260,6 +345,9 @@ int AudioPlayer::GetCurrentPosition() {
 }
 
 bool AudioPlayer::IsPlaying() {
+  if (sound_) {
+    return sound_pool_->IsPlaying(voice_id_);
+  }
   return (GetPlayerState() == PLAYER_STATE_PLAYING);
 }
 
@@ -313,6 +401,8 @@ void AudioPlayer::PreparePlayer() {
 }
 
 void AudioPlayer::ResetPlayer() {
+  // The duration of the next source must be reported even if it is the same.
+  reported_duration_ = -1;
   player_state_e state = GetPlayerState();
   switch (state) {
     case PLAYER_STATE_NONE:
@@ -341,6 +431,87 @@ void AudioPlayer::ResetPlayer() {
   }
 }
 
+void AudioPlayer::SetPlayerSource() {
+  int ret = PLAYER_ERROR_NONE;
+  if (audio_data_) {
+    ret = player_set_memory_buffer(player_, audio_data_->data(),
+                                   audio_data_->size());
+    if (ret != PLAYER_ERROR_NONE) {
+      throw AudioPlayerError("player_set_memory_buffer failed",
+                             get_error_message(ret));
+    }
+  } else {
+    ret = player_set_uri(player_, url_.c_str());
+    if (ret != PLAYER_ERROR_NONE) {
+      throw AudioPlayerError("player_set_uri failed", get_error_message(ret));
+    }
+  }
+}
+
+bool AudioPlayer::LoadSound() {
+  if (sound_) {
+    StopVoices();
+    sound_.reset();
+  }
+  if (!low_latency_) {
+    return false;
+  }
+
+  if (audio_data_) {
+    sound_ = sound_pool_->Load(audio_data_, audio_cache_key_);
+  } else if (!url_.empty() && url_.find("://") == std::string::npos) {
+    sound_ = sound_pool_->LoadFile(url_);
+  }
+  if (!sound_) {
+    return false;
+  }
+  should_seek_to_ = -1;
+  reported_duration_ = sound_->duration();
+  duration_listener_(player_id_, reported_duration_);
+  prepared_listener_(player_id_, true);
+  return true;
+}
+
+void AudioPlayer::PlaySound() {
+  int32_t position = std::max(should_seek_to_, 0);
+  should_seek_to_ = -1;
+  // Forget the voices that have been taken over by other players.
+  for (auto it = voices_.begin(); it != voices_.end();) {
+    if (sound_pool_->IsPlaying(*it) || sound_pool_->IsPaused(*it)) {
+      ++it;
+    } else {
+      it = voices_.erase(it);
+    }
+  }
+  voice_id_ = sound_pool_->Play(
+      sound_, position, volume_, release_mode_ == ReleaseMode::kLoop,
+      [this, is_alive = is_alive_](int voice_id) {
+        if (!*is_alive) {
+          return;
+        }
+        voices_.erase(voice_id);
+        if (voice_id != voice_id_) {
+          return;
+        }
+        voice_id_ = 0;
+        try {
+          Stop();
+          play_completed_listener_(player_id_);
+        } catch (const AudioPlayerError &error) {
+          log_listener_(player_id_, error.code());
+        }
+      });
+  voices_.insert(voice_id_);
+}
+
+void AudioPlayer::StopVoices() {
+  for (int voice_id : voices_) {
+    sound_pool_->Stop(voice_id);
+  }
+  voices_.clear();
+  voice_id_ = 0;
+}
+
 player_state_e AudioPlayer::GetPlayerState() {
   player_state_e state = PLAYER_STATE_NONE;
   if (player_) {
@@ -466,28 +637,21 @@ void AudioPlayer::OnError(int code, void *data) {
   player->log_listener_(player->player_id_, get_error_message(code));
 }
 
-void AudioPlayer::StartPositionUpdates() {
-  if (timer_id_ == 0) {
-    // The audioplayers app facing package expects position
-    // update events to fire roughly every 200 milliseconds.
-    const guint kTimeInterval = 200;
-    timer_id_ = g_timeout_add(kTimeInterval, OnPositionUpdate, this);
-    if (timer_id_ == 0) {
-      log_listener_(player_id_, "Failed to add a position update timer.");
-    }
-  }
-}
+void AudioPlayer::StartPositionUpdates() { position_ticker_->Add(this); }
 
-gboolean AudioPlayer::OnPositionUpdate(gpointer data) {
-  auto *player = reinterpret_cast<AudioPlayer *>(data);
+bool AudioPlayer::UpdatePosition() {
   try {
-    if (player->IsPlaying()) {
-      player->duration_listener_(player->player_id_, player->GetDuration());
-      return G_SOURCE_CONTINUE;
+    if (IsPlaying()) {
+      // Only changes are sent, so that idle players cost no channel messages.
+      int32_t duration = GetDuration();
+      if (duration != reported_duration_) {
+        reported_duration_ = duration;
+        duration_listener_(player_id_, duration);
+      }
+      return true;
     }
   } catch (const AudioPlayerError &error) {
-    player->log_listener_(player->player_id_, "Failed to update position.");
+    log_listener_(player_id_, "Failed to update position.");
   }
-  player->timer_id_ = 0;
-  return G_SOURCE_REMOVE;
+  return false;
 }
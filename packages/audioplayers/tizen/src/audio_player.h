@@ -10,9 +10,14 @@
 
 #include <functional>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "byte_source_cache.h"
+#include "position_ticker.h"
+#include "sound_pool.h"
+
 enum class ReleaseMode { kRelease, kLoop, kStop };
 
 using PreparedListener =
@@ -32,7 +37,8 @@ class AudioPlayer {
               DurationListener duration_listener,
               SeekCompletedListener seek_completed_listener,
               PlayCompletedListener play_completed_listener,
-              LogListener log_listener);
+              LogListener log_listener, SoundPool *sound_pool,
+              PositionTicker *position_ticker);
 
   ~AudioPlayer();
 
@@ -46,7 +52,9 @@ class AudioPlayer {
   // If you use HTTP or RTSP, URI must start with "http://" or "rtsp://".
   // The default protocol is "file://".
   void SetUrl(const std::string &url);
-  void SetDataSource(std::vector<uint8_t> &data);
+  // |data| may be shared with other players and must not be modified.
+  // |cache_key| is the key of |data| in the byte source cache, if any.
+  void SetDataSource(AudioBytes data, const std::string &cache_key);
   void SetVolume(double volume);
   void SetPlaybackRate(double playback_rate);
   void SetReleaseMode(ReleaseMode mode);
@@ -55,6 +63,9 @@ class AudioPlayer {
   int32_t GetCurrentPosition();
   std::string GetPlayerId() const { return player_id_; }
   bool IsPlaying();
+  // Called by |position_ticker_|. Returns false if the player is no longer
+  // playing.
+  bool UpdatePosition();
 
  private:
   // The player state should be none before calling this function.
@@ -62,6 +73,13 @@ class AudioPlayer {
   // The player state should be idle before calling this function.
   void PreparePlayer();
   void ResetPlayer();
+  void SetPlayerSource();
+  // Decodes the current source into |sound_| if the low latency mode is
+  // enabled and the source is a short local WAV file. Returns false if the
+  // source should be played by the player instead.
+  bool LoadSound();
+  void PlaySound();
+  void StopVoices();
   void StartPositionUpdates();
   player_state_e GetPlayerState();
 
@@ -72,12 +90,12 @@ class AudioPlayer {
   static void OnPlayCompleted(void *data);
   static void OnInterrupted(player_interrupted_code_e code, void *data);
   static void OnError(int code, void *data);
-  static gboolean OnPositionUpdate(gpointer data);
 
   player_h player_ = nullptr;
   const std::string player_id_;
   std::string url_;
-  std::vector<uint8_t> audio_data_;
+  AudioBytes audio_data_;
+  std::string audio_cache_key_;
   double volume_ = 1.0;
   double playback_rate_ = 1.0;
   ReleaseMode release_mode_ = ReleaseMode::kRelease;
@@ -85,7 +103,15 @@ class AudioPlayer {
   bool preparing_ = false;
   bool seeking_ = false;
   bool should_play_ = false;
-  guint timer_id_ = 0;
+  int32_t reported_duration_ = -1;
+  bool low_latency_ = false;
+  SoundPool *sound_pool_;
+  PositionTicker *position_ticker_;
+  std::shared_ptr<const Sound> sound_;
+  // The most recently started voice, and all voices of this player that may
+  // still be playing, as repeated plays overlap.
+  int voice_id_ = 0;
+  std::set<int> voices_;
   std::shared_ptr<bool> is_alive_ = std::make_shared<bool>(true);
 
   PreparedListener prepared_listener_;
@@ -19,6 +19,9 @@
 
 #include "audio_player.h"
 #include "audio_player_error.h"
+#include "byte_source_cache.h"
+#include "position_ticker.h"
+#include "sound_pool.h"
 
 namespace {
 
@@ -178,15 +181,36 @@ class AudioplayersTizenPlugin : public flutter::Plugin {
         return;
       }
       if (method_name == "setSourceBytes") {
-        std::vector<uint8_t> bytes =
-            GetRequiredArg<std::vector<uint8_t>>(arguments, "bytes");
+        // With a cacheKey, the bytes are sent only the first time and are
+        // shared by every player that uses the same key.
+        std::string cache_key;
+        bool has_cache_key =
+            GetValueFromEncodableMap(arguments, "cacheKey", cache_key);
+        std::vector<uint8_t> bytes;
+        AudioBytes data;
+        if (GetValueFromEncodableMap(arguments, "bytes", bytes)) {
+          if (has_cache_key) {
+            data = byte_source_cache_.Put(cache_key, std::move(bytes));
+          } else {
+            data = std::make_shared<const std::vector<uint8_t>>(
+                std::move(bytes));
+          }
+        } else if (has_cache_key) {
+          data = byte_source_cache_.Get(cache_key);
+          if (!data) {
+            throw std::invalid_argument("No bytes cached for " + cache_key +
+                                        ".");
+          }
+        } else {
+          throw std::invalid_argument("No bytes provided.");
+        }
 
         std::string mime_type;
         if (GetValueFromEncodableMap(arguments, "mimeType", mime_type)) {
           player->OnLog("mimeType parameter is not supported on Tizen.");
         }
 
-        player->SetDataSource(bytes);
+        player->SetDataSource(std::move(data), cache_key);
         result->Success();
       } else if (method_name == "resume") {
         player->Play();
@@ -292,6 +316,47 @@ class AudioplayersTizenPlugin : public flutter::Plugin {
           DisposeAudioPlayer(pair.first);
         }
         audio_players_.clear();
+      } else if (method_name == "cacheBytes") {
+        // Not part of the audioplayers API. Preloads bytes that players can
+        // later use by passing only the cacheKey to setSourceBytes.
+        if (!arguments) {
+          throw std::invalid_argument("No arguments provided.");
+        }
+        auto cache_key = GetRequiredArg<std::string>(arguments, "cacheKey");
+        auto bytes = GetRequiredArg<std::vector<uint8_t>>(arguments, "bytes");
+        byte_source_cache_.Put(cache_key, std::move(bytes));
+      } else if (method_name == "removeCachedBytes") {
+        if (!arguments) {
+          throw std::invalid_argument("No arguments provided.");
+        }
+        byte_source_cache_.Remove(
+            GetRequiredArg<std::string>(arguments, "cacheKey"));
+      } else if (method_name == "setBytesCacheSize") {
+        if (!arguments) {
+          throw std::invalid_argument("No arguments provided.");
+        }
+        int64_t max_bytes = 0;
+        int32_t max_bytes_32 = 0;
+        if (GetValueFromEncodableMap(arguments, "maxBytes", max_bytes_32)) {
+          max_bytes = max_bytes_32;
+        } else {
+          max_bytes = GetRequiredArg<int64_t>(arguments, "maxBytes");
+        }
+        if (max_bytes < 0) {
+          throw std::invalid_argument("maxBytes must not be negative.");
+        }
+        byte_source_cache_.SetMaxBytes(static_cast<size_t>(max_bytes));
+      } else if (method_name == "setPositionUpdateInterval") {
+        // Not part of the audioplayers API. Apps can call this through the
+        // global method channel to trade update frequency for wakeups.
+        if (!arguments) {
+          throw std::invalid_argument("No arguments provided.");
+        }
+        int32_t interval = GetRequiredArg<int32_t>(arguments, "interval");
+        if (interval <= 0) {
+          throw std::invalid_argument("The interval must be positive.");
+        }
+        position_ticker_.SetInterval(interval);
       } else if (method_name == "setAudioContext") {
         OnGlobalLog("Setting AudioContext is not supported on Tizen");
         result->NotImplemented();
@@ -383,7 +448,8 @@ class AudioplayersTizenPlugin : public flutter::Plugin {
 
     auto player = std::make_unique<AudioPlayer>(
         player_id, prepared_listener, duration_listener,
-        seek_completed_listener, play_completed_listener, log_listener);
+        seek_completed_listener, play_completed_listener, log_listener,
+        &sound_pool_, &position_ticker_);
     audio_players_[player_id] = std::move(player);
   }
 
@@ -400,6 +466,10 @@ class AudioplayersTizenPlugin : public flutter::Plugin {
     global_event_sinks_->Success(flutter::EncodableValue(map));
   }
 
+  // Declared before |audio_players_| so that they outlive the players.
+  SoundPool sound_pool_;
+  PositionTicker position_ticker_;
+  ByteSourceCache byte_source_cache_;
   std::map<std::string, std::unique_ptr<AudioPlayer>> audio_players_;
   std::map<std::string, std::unique_ptr<FlEventSink>> event_sinks_;
   std::unique_ptr<FlEventSink> global_event_sinks_;
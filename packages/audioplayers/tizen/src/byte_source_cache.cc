@@ -0,0 +1,49 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "byte_source_cache.h"
+
+AudioBytes ByteSourceCache::Put(const std::string &key,
+                                std::vector<uint8_t> &&bytes) {
+  Remove(key);
+  auto data = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+  entries_.emplace_front(key, data);
+  index_[key] = entries_.begin();
+  bytes_ += data->size();
+  Evict();
+  return data;
+}
+
+AudioBytes ByteSourceCache::Get(const std::string &key) {
+  auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  return iter->second->second;
+}
+
+void ByteSourceCache::Remove(const std::string &key) {
+  auto iter = index_.find(key);
+  if (iter != index_.end()) {
+    bytes_ -= iter->second->second->size();
+    entries_.erase(iter->second);
+    index_.erase(iter);
+  }
+}
+
+void ByteSourceCache::SetMaxBytes(size_t max_bytes) {
+  max_bytes_ = max_bytes;
+  Evict();
+}
+
+void ByteSourceCache::Evict() {
+  // The most recent entry is kept even if it exceeds the budget by itself,
+  // since it is about to be played.
+  while (bytes_ > max_bytes_ && entries_.size() > 1) {
+    bytes_ -= entries_.back().second->size();
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
@@ -0,0 +1,48 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_PLUGIN_BYTE_SOURCE_CACHE_H_
+#define FLUTTER_PLUGIN_BYTE_SOURCE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using AudioBytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+// Keeps byte sources in native memory under caller-supplied keys, so that
+// the same bytes need to cross the method channel only once and can be
+// shared by any number of players.
+class ByteSourceCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 32 * 1024 * 1024;
+
+  ByteSourceCache() {}
+  ~ByteSourceCache() {}
+
+  // Stores |bytes| under |key|, replacing any previous entry.
+  AudioBytes Put(const std::string &key, std::vector<uint8_t> &&bytes);
+  // Returns the bytes stored under |key|, or nullptr if there are none.
+  AudioBytes Get(const std::string &key);
+  void Remove(const std::string &key);
+
+  // The least recently used entries are evicted once the cache holds more
+  // than |max_bytes|. Evicted bytes stay alive as long as a player uses
+  // them.
+  void SetMaxBytes(size_t max_bytes);
+
+ private:
+  void Evict();
+
+  // The most recently used entries come first.
+  std::list<std::pair<std::string, AudioBytes>> entries_;
+  std::map<std::string, decltype(entries_)::iterator> index_;
+  size_t bytes_ = 0;
+  size_t max_bytes_ = kDefaultMaxBytes;
+};
+
+#endif  // FLUTTER_PLUGIN_BYTE_SOURCE_CACHE_H_
@@ -0,0 +1,73 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "position_ticker.h"
+
+#include <algorithm>
+
+#include "audio_player.h"
+#include "log.h"
+
+PositionTicker::PositionTicker() {}
+
+PositionTicker::~PositionTicker() { Stop(); }
+
+void PositionTicker::Add(AudioPlayer *player) {
+  if (std::find(players_.begin(), players_.end(), player) == players_.end()) {
+    players_.push_back(player);
+  }
+  Start();
+}
+
+void PositionTicker::Remove(AudioPlayer *player) {
+  players_.erase(std::remove(players_.begin(), players_.end(), player),
+                 players_.end());
+  if (players_.empty()) {
+    Stop();
+  }
+}
+
+void PositionTicker::SetInterval(guint interval) {
+  if (interval_ != interval) {
+    interval_ = interval;
+    if (timer_id_ != 0) {
+      Stop();
+      Start();
+    }
+  }
+}
+
+void PositionTicker::Start() {
+  if (timer_id_ == 0) {
+    timer_id_ = g_timeout_add(interval_, OnTick, this);
+    if (timer_id_ == 0) {
+      LOG_ERROR("Failed to add a position update timer.");
+    }
+  }
+}
+
+void PositionTicker::Stop() {
+  if (timer_id_ != 0) {
+    g_source_remove(timer_id_);
+    timer_id_ = 0;
+  }
+}
+
+gboolean PositionTicker::OnTick(gpointer data) {
+  auto *ticker = static_cast<PositionTicker *>(data);
+  // A player may be removed while it is being updated.
+  std::vector<AudioPlayer *> players = ticker->players_;
+  for (AudioPlayer *player : players) {
+    if (!player->UpdatePosition()) {
+      ticker->players_.erase(std::remove(ticker->players_.begin(),
+                                         ticker->players_.end(), player),
+                             ticker->players_.end());
+    }
+  }
+  if (ticker->players_.empty()) {
+    ticker->timer_id_ = 0;
+    return G_SOURCE_REMOVE;
+  }
+  return G_SOURCE_CONTINUE;
+}
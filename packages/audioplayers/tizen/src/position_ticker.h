@@ -0,0 +1,42 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_PLUGIN_POSITION_TICKER_H_
+#define FLUTTER_PLUGIN_POSITION_TICKER_H_
+
+#include <glib.h>
+
+#include <vector>
+
+class AudioPlayer;
+
+// A single timer that updates every playing player, instead of one timer
+// per player.
+class PositionTicker {
+ public:
+  // The audioplayers app facing package expects position update events to
+  // fire roughly every 200 milliseconds.
+  static constexpr guint kDefaultInterval = 200;  // milliseconds
+
+  PositionTicker();
+  ~PositionTicker();
+
+  // Updates |player| on every tick until it stops playing.
+  void Add(AudioPlayer *player);
+  void Remove(AudioPlayer *player);
+
+  void SetInterval(guint interval);
+
+ private:
+  void Start();
+  void Stop();
+
+  static gboolean OnTick(gpointer data);
+
+  std::vector<AudioPlayer *> players_;
+  guint interval_ = kDefaultInterval;
+  guint timer_id_ = 0;
+};
+
+#endif  // FLUTTER_PLUGIN_POSITION_TICKER_H_
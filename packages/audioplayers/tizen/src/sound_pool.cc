@@ -0,0 +1,506 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "sound_pool.h"
+
+#include <glib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include "audio_player_error.h"
+
+namespace {
+
+// Longer sounds are left to the media player.
+constexpr int32_t kMaxSoundDuration = 10000;  // milliseconds
+constexpr size_t kMaxFileSize = 8 * 1024 * 1024;
+constexpr size_t kMaxCacheBytes = 16 * 1024 * 1024;
+constexpr size_t kMaxVoices = 8;
+
+constexpr uint16_t kWaveFormatPcm = 1;
+constexpr uint16_t kWaveFormatFloat = 3;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+struct IdleData {
+  SoundPool *pool;
+  std::shared_ptr<bool> is_alive;
+};
+
+uint16_t ReadUint16(const uint8_t *data) { return data[0] | data[1] << 8; }
+
+uint32_t ReadUint32(const uint8_t *data) {
+  return data[0] | data[1] << 8 | data[2] << 16 |
+         static_cast<uint32_t>(data[3]) << 24;
+}
+
+bool IsWav(const uint8_t *data, size_t size) {
+  return size >= 12 && memcmp(data, "RIFF", 4) == 0 &&
+         memcmp(data + 8, "WAVE", 4) == 0;
+}
+
+// Returns a sample normalized to [-1, 1].
+float ReadSample(const uint8_t *data, uint16_t format, uint16_t bits) {
+  if (format == kWaveFormatFloat) {
+    float value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+  }
+  switch (bits) {
+    case 8:
+      return (data[0] - 128) / 128.0f;
+    case 16:
+      return static_cast<int16_t>(ReadUint16(data)) / 32768.0f;
+    case 24:
+      return static_cast<int32_t>(static_cast<uint32_t>(data[0]) << 8 |
+                                  static_cast<uint32_t>(data[1]) << 16 |
+                                  static_cast<uint32_t>(data[2]) << 24) /
+             2147483648.0f;
+    default:
+      return static_cast<int32_t>(ReadUint32(data)) / 2147483648.0f;
+  }
+}
+
+// Decodes a PCM WAV file, converting it to stereo at SoundPool::kSampleRate.
+std::shared_ptr<Sound> DecodeWav(const uint8_t *data, size_t size) {
+  if (!IsWav(data, size)) {
+    return nullptr;
+  }
+
+  uint16_t format = 0, channels = 0, bits = 0;
+  uint32_t sample_rate = 0;
+  const uint8_t *pcm = nullptr;
+  size_t pcm_size = 0;
+  size_t offset = 12;
+  while (offset + 8 <= size) {
+    const uint8_t *chunk = data + offset + 8;
+    size_t chunk_size = ReadUint32(data + offset + 4);
+    size_t available = size - offset - 8;
+    if (memcmp(data + offset, "fmt ", 4) == 0 && chunk_size >= 16 &&
+        available >= 16) {
+      format = ReadUint16(chunk);
+      channels = ReadUint16(chunk + 2);
+      sample_rate = ReadUint32(chunk + 4);
+      bits = ReadUint16(chunk + 14);
+      if (format == kWaveFormatExtensible && chunk_size >= 26 &&
+          available >= 26) {
+        format = ReadUint16(chunk + 24);
+      }
+    } else if (memcmp(data + offset, "data", 4) == 0) {
+      pcm = chunk;
+      pcm_size = std::min(chunk_size, available);
+      break;
+    }
+    offset += 8 + chunk_size + (chunk_size & 1);
+  }
+
+  bool supported =
+      (format == kWaveFormatPcm &&
+       (bits == 8 || bits == 16 || bits == 24 || bits == 32)) ||
+      (format == kWaveFormatFloat && bits == 32);
+  if (!pcm || !supported || channels == 0 || sample_rate == 0) {
+    return nullptr;
+  }
+  size_t sample_bytes = bits / 8;
+  size_t frame_bytes = sample_bytes * channels;
+  size_t in_frames = pcm_size / frame_bytes;
+  if (in_frames == 0 ||
+      in_frames > static_cast<uint64_t>(sample_rate) * kMaxSoundDuration /
+                      1000) {
+    return nullptr;
+  }
+
+  auto sound = std::make_shared<Sound>();
+  size_t out_frames = static_cast<uint64_t>(in_frames) *
+                      SoundPool::kSampleRate / sample_rate;
+  sound->samples.resize(out_frames * 2);
+  double step = static_cast<double>(sample_rate) / SoundPool::kSampleRate;
+  for (size_t frame = 0; frame < out_frames; frame++) {
+    // Linear interpolation between the two nearest input frames.
+    double source = frame * step;
+    size_t first = static_cast<size_t>(source);
+    size_t second = std::min(first + 1, in_frames - 1);
+    float weight = static_cast<float>(source - first);
+    for (uint16_t channel = 0; channel < 2; channel++) {
+      size_t channel_offset =
+          std::min<uint16_t>(channel, channels - 1) * sample_bytes;
+      float value =
+          ReadSample(pcm + first * frame_bytes + channel_offset, format,
+                     bits) *
+              (1.0f - weight) +
+          ReadSample(pcm + second * frame_bytes + channel_offset, format,
+                     bits) *
+              weight;
+      sound->samples[frame * 2 + channel] = static_cast<int16_t>(
+          std::clamp(std::lrint(value * 32767.0f), -32768L, 32767L));
+    }
+  }
+  return sound;
+}
+
+}  // namespace
+
+int32_t Sound::duration() const {
+  return static_cast<int32_t>(static_cast<uint64_t>(frames()) * 1000 /
+                              SoundPool::kSampleRate);
+}
+
+SoundPool::SoundPool() {}
+
+SoundPool::~SoundPool() {
+  *is_alive_ = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closing_ = true;
+    mix_done_.wait(lock, [this] { return !mixing_; });
+  }
+  if (stream_) {
+    audio_out_unprepare(stream_);
+    audio_out_unset_stream_cb(stream_);
+    audio_out_destroy(stream_);
+    stream_ = nullptr;
+  }
+}
+
+std::shared_ptr<const Sound> SoundPool::Load(const AudioBytes &data,
+                                             const std::string &cache_key) {
+  if (!IsWav(data->data(), data->size())) {
+    return nullptr;
+  }
+  std::string key;
+  if (!cache_key.empty()) {
+    key = "key:" + cache_key;
+  } else {
+    std::string_view view(reinterpret_cast<const char *>(data->data()),
+                          data->size());
+    key = "bytes:" + std::to_string(data->size()) + ":" +
+          std::to_string(std::hash<std::string_view>{}(view));
+  }
+  auto iter = cache_index_.find(key);
+  if (iter != cache_index_.end()) {
+    // A cache key may have been given new bytes since, and hashes may
+    // collide, so the key alone does not identify the sound.
+    AudioBytes source = iter->second->source.lock();
+    if (source && (source == data || *source == *data)) {
+      cache_.splice(cache_.begin(), cache_, iter->second);
+      return iter->second->sound;
+    }
+    cache_bytes_ -= iter->second->sound->samples.size() * sizeof(int16_t);
+    cache_.erase(iter->second);
+    cache_index_.erase(iter);
+  }
+  return Cache(key, data, DecodeWav(data->data(), data->size()));
+}
+
+std::shared_ptr<const Sound> SoundPool::LoadFile(const std::string &path) {
+  std::string key = "file:" + path;
+  auto iter = cache_index_.find(key);
+  if (iter != cache_index_.end()) {
+    cache_.splice(cache_.begin(), cache_, iter->second);
+    return iter->second->sound;
+  }
+
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return nullptr;
+  }
+  std::streamsize size = file.tellg();
+  if (size < 12 || static_cast<size_t>(size) > kMaxFileSize) {
+    return nullptr;
+  }
+  std::vector<uint8_t> data(12);
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char *>(data.data()), data.size()) ||
+      !IsWav(data.data(), data.size())) {
+    return nullptr;
+  }
+  data.resize(size);
+  if (!file.read(reinterpret_cast<char *>(data.data() + 12), size - 12)) {
+    return nullptr;
+  }
+  return Cache(key, nullptr, DecodeWav(data.data(), data.size()));
+}
+
+std::shared_ptr<const Sound> SoundPool::Cache(
+    const std::string &key, const AudioBytes &source,
+    std::shared_ptr<const Sound> sound) {
+  if (!sound) {
+    return nullptr;
+  }
+  cache_.push_front(CacheEntry{key, source, sound});
+  cache_index_[key] = cache_.begin();
+  cache_bytes_ += sound->samples.size() * sizeof(int16_t);
+
+  // Evicted sounds stay alive as long as a player uses them.
+  while (cache_bytes_ > kMaxCacheBytes && cache_.size() > 1) {
+    cache_bytes_ -= cache_.back().sound->samples.size() * sizeof(int16_t);
+    cache_index_.erase(cache_.back().key);
+    cache_.pop_back();
+  }
+  return sound;
+}
+
+int SoundPool::Play(std::shared_ptr<const Sound> sound, int32_t position,
+                    double volume, bool loop,
+                    std::function<void(int voice_id)> on_completed) {
+  int voice_id = next_voice_id_++;
+  Voice voice;
+  voice.id = voice_id;
+  voice.position = std::min(
+      static_cast<size_t>(std::max(position, 0)) * kSampleRate / 1000,
+      sound->frames());
+  voice.sound = std::move(sound);
+  voice.volume = static_cast<float>(volume);
+  voice.loop = loop;
+  voice.on_completed = std::move(on_completed);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (voices_.size() >= kMaxVoices) {
+      voices_.erase(voices_.begin());
+    }
+    voices_.push_back(std::move(voice));
+    stream_idle_ = false;
+  }
+  // Must not be called with |mutex_| held, since the audio thread may be
+  // waiting for it.
+  StartStream();
+  return voice_id;
+}
+
+void SoundPool::Pause(int voice_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (Voice *voice = FindVoice(voice_id)) {
+    voice->paused = true;
+  }
+}
+
+void SoundPool::Resume(int voice_id) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Voice *voice = FindVoice(voice_id);
+    if (!voice) {
+      return;
+    }
+    voice->paused = false;
+    stream_idle_ = false;
+  }
+  StartStream();
+}
+
+void SoundPool::Stop(int voice_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  voices_.erase(std::remove_if(voices_.begin(), voices_.end(),
+                               [voice_id](const Voice &voice) {
+                                 return voice.id == voice_id;
+                               }),
+                voices_.end());
+}
+
+void SoundPool::Seek(int voice_id, int32_t position) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (Voice *voice = FindVoice(voice_id)) {
+    voice->position = std::min(
+        static_cast<size_t>(std::max(position, 0)) * kSampleRate / 1000,
+        voice->sound->frames());
+  }
+}
+
+void SoundPool::SetVolume(int voice_id, double volume) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (Voice *voice = FindVoice(voice_id)) {
+    voice->volume = static_cast<float>(volume);
+  }
+}
+
+void SoundPool::SetLooping(int voice_id, bool loop) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (Voice *voice = FindVoice(voice_id)) {
+    voice->loop = loop;
+  }
+}
+
+bool SoundPool::IsPlaying(int voice_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Voice *voice = FindVoice(voice_id);
+  return voice && !voice->paused;
+}
+
+bool SoundPool::IsPaused(int voice_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Voice *voice = FindVoice(voice_id);
+  return voice && voice->paused;
+}
+
+int32_t SoundPool::GetPosition(int voice_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (Voice *voice = FindVoice(voice_id)) {
+    return static_cast<int32_t>(static_cast<uint64_t>(voice->position) *
+                                1000 / kSampleRate);
+  }
+  return 0;
+}
+
+SoundPool::Voice *SoundPool::FindVoice(int voice_id) {
+  for (Voice &voice : voices_) {
+    if (voice.id == voice_id) {
+      return &voice;
+    }
+  }
+  return nullptr;
+}
+
+void SoundPool::StartStream() {
+  if (!stream_) {
+    int ret = audio_out_create_new(kSampleRate, AUDIO_CHANNEL_STEREO,
+                                   AUDIO_SAMPLE_TYPE_S16_LE, &stream_);
+    if (ret != AUDIO_IO_ERROR_NONE) {
+      stream_ = nullptr;
+      throw AudioPlayerError("audio_out_create_new failed",
+                             get_error_message(ret));
+    }
+    ret = audio_out_set_stream_cb(stream_, OnStreamRequested, this);
+    if (ret != AUDIO_IO_ERROR_NONE) {
+      audio_out_destroy(stream_);
+      stream_ = nullptr;
+      throw AudioPlayerError("audio_out_set_stream_cb failed",
+                             get_error_message(ret));
+    }
+    ret = audio_out_prepare(stream_);
+    if (ret != AUDIO_IO_ERROR_NONE) {
+      audio_out_destroy(stream_);
+      stream_ = nullptr;
+      throw AudioPlayerError("audio_out_prepare failed",
+                             get_error_message(ret));
+    }
+  } else if (stream_paused_) {
+    int ret = audio_out_resume(stream_);
+    if (ret != AUDIO_IO_ERROR_NONE) {
+      throw AudioPlayerError("audio_out_resume failed",
+                             get_error_message(ret));
+    }
+    stream_paused_ = false;
+  }
+}
+
+void SoundPool::Mix(audio_out_h handle, size_t nbytes) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_) {
+      return;
+    }
+    mixing_ = true;
+  }
+
+  size_t samples = nbytes / sizeof(int16_t);
+  mix_buffer_.assign(samples, 0);
+  output_buffer_.resize(samples);
+
+  std::vector<std::pair<int, std::function<void(int)>>> completed;
+  bool became_idle = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool idle = true;
+    for (auto iter = voices_.begin(); iter != voices_.end();) {
+      Voice &voice = *iter;
+      if (voice.paused) {
+        ++iter;
+        continue;
+      }
+      const std::vector<int16_t> &source = voice.sound->samples;
+      size_t frames = voice.sound->frames();
+      for (size_t index = 0; index < samples; index += 2) {
+        if (voice.position >= frames) {
+          if (!voice.loop || frames == 0) {
+            break;
+          }
+          voice.position = 0;
+        }
+        mix_buffer_[index] +=
+            std::lrint(source[voice.position * 2] * voice.volume);
+        mix_buffer_[index + 1] +=
+            std::lrint(source[voice.position * 2 + 1] * voice.volume);
+        voice.position++;
+      }
+      if (voice.position >= frames && !voice.loop) {
+        completed.emplace_back(voice.id, std::move(voice.on_completed));
+        iter = voices_.erase(iter);
+      } else {
+        idle = false;
+        ++iter;
+      }
+    }
+    if (idle && !stream_idle_) {
+      stream_idle_ = true;
+      became_idle = true;
+    }
+  }
+
+  for (size_t index = 0; index < samples; index++) {
+    output_buffer_[index] =
+        static_cast<int16_t>(std::clamp(mix_buffer_[index], -32768, 32767));
+  }
+  audio_out_write(handle, output_buffer_.data(), nbytes);
+
+  for (auto &[voice_id, on_completed] : completed) {
+    if (!on_completed) {
+      continue;
+    }
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT,
+        [](gpointer data) -> gboolean {
+          auto *callback = static_cast<std::function<void()> *>(data);
+          (*callback)();
+          return G_SOURCE_REMOVE;
+        },
+        new std::function<void()>(
+            [voice_id = voice_id, on_completed = std::move(on_completed)]() {
+              on_completed(voice_id);
+            }),
+        [](gpointer data) {
+          delete static_cast<std::function<void()> *>(data);
+        });
+  }
+
+  if (became_idle) {
+    // Stop requesting silence until a voice plays again.
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT_IDLE,
+        [](gpointer data) -> gboolean {
+          auto *idle = static_cast<IdleData *>(data);
+          if (!*idle->is_alive) {
+            return G_SOURCE_REMOVE;
+          }
+          SoundPool *pool = idle->pool;
+          {
+            std::lock_guard<std::mutex> lock(pool->mutex_);
+            if (!pool->stream_idle_) {
+              return G_SOURCE_REMOVE;
+            }
+          }
+          if (!pool->stream_paused_ &&
+              audio_out_pause(pool->stream_) == AUDIO_IO_ERROR_NONE) {
+            pool->stream_paused_ = true;
+          }
+          return G_SOURCE_REMOVE;
+        },
+        new IdleData{this, is_alive_},
+        [](gpointer data) { delete static_cast<IdleData *>(data); });
+  }
+
+  // Notify with |mutex_| held, since the destructor may return as soon as
+  // it sees |mixing_| cleared.
+  std::lock_guard<std::mutex> lock(mutex_);
+  mixing_ = false;
+  mix_done_.notify_all();
+}
+
+void SoundPool::OnStreamRequested(audio_out_h handle, size_t nbytes,
+                                  void *user_data) {
+  // Called on the audio thread.
+  auto *pool = static_cast<SoundPool *>(user_data);
+  pool->Mix(handle, nbytes);
+}
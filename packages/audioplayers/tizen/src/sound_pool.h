@@ -0,0 +1,119 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_PLUGIN_SOUND_POOL_H_
+#define FLUTTER_PLUGIN_SOUND_POOL_H_
+
+#include <audio_io.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "byte_source_cache.h"
+
+// A sound decoded into interleaved stereo 16-bit PCM at
+// SoundPool::kSampleRate.
+struct Sound {
+  std::vector<int16_t> samples;
+
+  size_t frames() const { return samples.size() / 2; }
+  int32_t duration() const;  // milliseconds
+};
+
+// Plays short sounds decoded in memory through a single audio output stream
+// shared by all players in the low latency mode, so that starting a sound
+// does not need to prepare a player.
+class SoundPool {
+ public:
+  static constexpr int kSampleRate = 48000;
+
+  SoundPool();
+  ~SoundPool();
+
+  // Returns the sound decoded from |data|, or nullptr if |data| is not a
+  // short PCM WAV file. Decoded sounds are cached under |cache_key|, the key
+  // of |data| in the byte source cache, or under a hash of |data| if it is
+  // empty, so the same data is decoded only once.
+  std::shared_ptr<const Sound> Load(const AudioBytes &data,
+                                    const std::string &cache_key);
+  // Same as above, but reads the data from the file at |path|.
+  std::shared_ptr<const Sound> LoadFile(const std::string &path);
+
+  // Starts playing |sound| from |position| and returns the ID of the voice
+  // that plays it. If every voice is busy, the oldest one is stopped.
+  // |on_completed| is called on the main thread with the voice ID if the
+  // voice reaches the end of the sound without looping.
+  int Play(std::shared_ptr<const Sound> sound, int32_t position,
+           double volume, bool loop,
+           std::function<void(int voice_id)> on_completed);
+  void Pause(int voice_id);
+  void Resume(int voice_id);
+  void Stop(int voice_id);
+  void Seek(int voice_id, int32_t position);  // milliseconds
+  void SetVolume(int voice_id, double volume);
+  void SetLooping(int voice_id, bool loop);
+  bool IsPlaying(int voice_id);
+  bool IsPaused(int voice_id);
+  int32_t GetPosition(int voice_id);  // milliseconds
+
+ private:
+  struct Voice {
+    int id = 0;
+    std::shared_ptr<const Sound> sound;
+    size_t position = 0;  // frames
+    float volume = 1.0f;
+    bool loop = false;
+    bool paused = false;
+    std::function<void(int voice_id)> on_completed;
+  };
+
+  struct CacheEntry {
+    std::string key;
+    // The bytes the sound was decoded from, if not read from a file.
+    std::weak_ptr<const std::vector<uint8_t>> source;
+    std::shared_ptr<const Sound> sound;
+  };
+
+  std::shared_ptr<const Sound> Cache(const std::string &key,
+                                     const AudioBytes &source,
+                                     std::shared_ptr<const Sound> sound);
+  Voice *FindVoice(int voice_id);
+  void StartStream();
+  void Mix(audio_out_h handle, size_t nbytes);
+
+  static void OnStreamRequested(audio_out_h handle, size_t nbytes,
+                                void *user_data);
+
+  // Guards |voices_|, |stream_idle_|, |closing_| and |mixing_|, which are
+  // also accessed by the audio thread.
+  std::mutex mutex_;
+  // Set by the destructor to stop the audio thread from mixing, which it
+  // then waits to finish, as signaled by |mix_done_|.
+  bool closing_ = false;
+  bool mixing_ = false;
+  std::condition_variable mix_done_;
+  std::vector<Voice> voices_;
+  int next_voice_id_ = 1;
+  audio_out_h stream_ = nullptr;
+  bool stream_paused_ = false;
+  bool stream_idle_ = false;
+  std::vector<int32_t> mix_buffer_;
+  std::vector<int16_t> output_buffer_;
+
+  // The most recently used sounds come first.
+  std::list<CacheEntry> cache_;
+  std::map<std::string, decltype(cache_)::iterator> cache_index_;
+  size_t cache_bytes_ = 0;
+
+  std::shared_ptr<bool> is_alive_ = std::make_shared<bool>(true);
+};
+
+#endif  // FLUTTER_PLUGIN_SOUND_POOL_H_
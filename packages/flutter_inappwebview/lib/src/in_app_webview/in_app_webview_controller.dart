@@ -1063,6 +1063,19 @@ class TizenInAppWebViewController extends PlatformInAppWebViewController
     return id;
   }
 
+  /// Returns the counters of the surface pool this WebView renders into, for
+  /// tuning purposes.
+  ///
+  /// The pool adapts its size between `minSize` and `maxSize` based on how
+  /// often it runs out of surfaces (`exhausted`) and how long the engine holds
+  /// a surface (`releaseLatencyUs`) compared with the interval between frames
+  /// (`acquireIntervalUs`).
+  Future<Map<String, Object?>> getBufferPoolMetrics() async {
+    final Map<Object?, Object?>? metrics = await channel
+        ?.invokeMethod<Map<Object?, Object?>>('getBufferPoolMetrics');
+    return metrics?.cast<String, Object?>() ?? <String, Object?>{};
+  }
+
   @override
   void dispose({bool isKeepAlive = false}) {
     disposeChannel();
@@ -1,180 +1,379 @@
-// Copyright 2026 Samsung Electronics Co., Ltd. All rights reserved.
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
 #include "buffer_pool.h"
 
-#include <atomic>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
 
 struct BufferReleaseState {
-  std::atomic_bool is_used = false;
+  // The number of users of the unit, including the descriptors held by the
+  // engine.
+  std::atomic<int> use_count = 0;
+  // The longest time the engine held a descriptor since the pool last asked.
+  std::atomic<int64_t> release_latency_us = 0;
 };
 
 namespace {
 
+// The number of acquisitions after which the pool size is reconsidered.
+constexpr uint64_t kAdaptWindow = 120;
+
+int64_t NowMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 struct GpuSurfaceDescriptorContext {
   std::shared_ptr<BufferReleaseState> release_state;
+  int64_t obtained_us = 0;
   FlutterDesktopGpuSurfaceDescriptor descriptor = {};
 };
 
 void ReleaseGpuSurfaceDescriptor(void* release_context) {
   auto context =
       reinterpret_cast<GpuSurfaceDescriptorContext*>(release_context);
-  context->release_state->is_used.store(false);
+  int64_t latency = NowMicroseconds() - context->obtained_us;
+  std::atomic<int64_t>& longest = context->release_state->release_latency_us;
+  int64_t current = longest.load();
+  while (latency > current &&
+         !longest.compare_exchange_weak(current, latency)) {
+  }
+  context->release_state->use_count--;
   delete context;
 }
 
 }  // namespace
 
-BufferUnit::BufferUnit(int32_t width, int32_t height)
-    : release_state_(std::make_shared<BufferReleaseState>()) {
-  Reset(width, height);
+flutter::EncodableMap BufferPoolMetrics::ToEncodableMap() const {
+  return {
+      {flutter::EncodableValue("size"),
+       flutter::EncodableValue(static_cast<int64_t>(size))},
+      {flutter::EncodableValue("minSize"),
+       flutter::EncodableValue(static_cast<int64_t>(min_size))},
+      {flutter::EncodableValue("maxSize"),
+       flutter::EncodableValue(static_cast<int64_t>(max_size))},
+      {flutter::EncodableValue("acquired"),
+       flutter::EncodableValue(static_cast<int64_t>(acquired))},
+      {flutter::EncodableValue("exhausted"),
+       flutter::EncodableValue(static_cast<int64_t>(exhausted))},
+      {flutter::EncodableValue("grown"),
+       flutter::EncodableValue(static_cast<int64_t>(grown))},
+      {flutter::EncodableValue("shrunk"),
+       flutter::EncodableValue(static_cast<int64_t>(shrunk))},
+      {flutter::EncodableValue("peakInUse"),
+       flutter::EncodableValue(static_cast<int64_t>(peak_in_use))},
+      {flutter::EncodableValue("averageInUse"),
+       flutter::EncodableValue(average_in_use)},
+      {flutter::EncodableValue("releaseLatencyUs"),
+       flutter::EncodableValue(release_latency_us)},
+      {flutter::EncodableValue("acquireIntervalUs"),
+       flutter::EncodableValue(acquire_interval_us)},
+  };
 }
 
-BufferUnit::~BufferUnit() {
-  if (tbm_surface_ && !use_external_buffer_) {
-    tbm_surface_destroy(tbm_surface_);
-    tbm_surface_ = nullptr;
-  }
+BufferUnit::BufferUnit(int32_t width, int32_t height, tbm_format format,
+                       bool use_external_buffer)
+    : release_state_(std::make_shared<BufferReleaseState>()),
+      use_external_buffer_(use_external_buffer),
+      format_(format) {
+  Reset(width, height);
 }
 
-void BufferUnit::UseExternalBuffer() {
-  if (!use_external_buffer_) {
-    use_external_buffer_ = true;
-    if (tbm_surface_) {
-      tbm_surface_destroy(tbm_surface_);
-      tbm_surface_ = nullptr;
-    }
+BufferUnit::~BufferUnit() {
+  tbm_surface_h tbm_surface = tbm_surface_.exchange(nullptr);
+  if (tbm_surface && !use_external_buffer_) {
+    tbm_surface_destroy(tbm_surface);
   }
 }
 
 void BufferUnit::SetExternalBuffer(tbm_surface_h tbm_surface) {
   if (use_external_buffer_) {
-    tbm_surface_ = tbm_surface;
+    tbm_surface_.store(tbm_surface);
   }
 }
 
 bool BufferUnit::MarkInUse() {
-  bool expected = false;
-  return release_state_->is_used.compare_exchange_strong(expected, true);
+  int expected = 0;
+  return release_state_->use_count.compare_exchange_strong(expected, 1);
 }
 
-void BufferUnit::UnmarkInUse() { release_state_->is_used.store(false); }
+void BufferUnit::UnmarkInUse() { release_state_->use_count--; }
 
 bool BufferUnit::IsUsed() {
-  return release_state_->is_used.load() && tbm_surface_;
+  return release_state_->use_count.load() > 0 && tbm_surface_.load();
+}
+
+int64_t BufferUnit::TakeReleaseLatency() {
+  return release_state_->release_latency_us.exchange(0);
 }
 
 tbm_surface_h BufferUnit::Surface() {
   if (IsUsed()) {
-    return tbm_surface_;
+    return tbm_surface_.load();
   }
   return nullptr;
 }
 
-void BufferUnit::Reset(int32_t width, int32_t height) {
+bool BufferUnit::Reset(int32_t width, int32_t height) {
   if (width_ == width && height_ == height) {
-    return;
+    return tbm_surface_.load() != nullptr;
   }
   width_ = width;
   height_ = height;
 
-  if (tbm_surface_ && !use_external_buffer_) {
-    tbm_surface_destroy(tbm_surface_);
+  // Unpublish the surface before destroying it.
+  tbm_surface_h old_surface = tbm_surface_.exchange(nullptr);
+  if (old_surface && !use_external_buffer_) {
+    tbm_surface_destroy(old_surface);
   }
-  tbm_surface_ = nullptr;
 
-  if (!use_external_buffer_) {
-    tbm_surface_ = tbm_surface_create(width_, height_, TBM_FORMAT_ARGB8888);
+  if (!use_external_buffer_ && width_ > 0 && height_ > 0) {
+    tbm_surface_.store(tbm_surface_create(width_, height_, format_));
   }
+  return tbm_surface_.load() != nullptr;
 }
 
 FlutterDesktopGpuSurfaceDescriptor* BufferUnit::GpuSurface() {
-  if (!tbm_surface_) {
-    UnmarkInUse();
+  tbm_surface_h tbm_surface = tbm_surface_.load();
+  if (!tbm_surface) {
     return nullptr;
   }
 
+  release_state_->use_count++;
   auto context = new GpuSurfaceDescriptorContext();
   context->release_state = release_state_;
+  context->obtained_us = NowMicroseconds();
   context->descriptor.width = width_;
   context->descriptor.height = height_;
-  context->descriptor.handle = tbm_surface_;
+  context->descriptor.handle = tbm_surface;
   context->descriptor.release_callback = ReleaseGpuSurfaceDescriptor;
   context->descriptor.release_context = context;
   return &context->descriptor;
 }
 
-BufferPool::BufferPool(int32_t width, int32_t height, size_t pool_size) {
-  for (size_t index = 0; index < pool_size; index++) {
-    pool_.emplace_back(std::make_unique<BufferUnit>(width, height));
+BufferPool::BufferPool(int32_t width, int32_t height, size_t pool_size,
+                       tbm_format format)
+    : BufferPool(width, height, pool_size, pool_size, format) {}
+
+BufferPool::BufferPool(int32_t width, int32_t height, size_t min_pool_size,
+                       size_t max_pool_size, tbm_format format,
+                       bool use_external_buffer)
+    : min_size_(min_pool_size),
+      format_(format),
+      use_external_buffer_(use_external_buffer),
+      width_(width),
+      height_(height) {
+  pool_.resize(std::max(min_pool_size, max_pool_size));
+  for (size_t index = 0; index < min_pool_size; index++) {
+    pool_[index] = std::make_unique<BufferUnit>(width, height, format,
+                                                use_external_buffer);
   }
-  Prepare(width, height);
+  size_.store(min_pool_size);
 }
 
 BufferPool::~BufferPool() {}
 
 BufferUnit* BufferPool::GetAvailableBuffer() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  for (size_t index = 0; index < pool_.size(); index++) {
-    size_t current = (index + last_index_) % pool_.size();
+  int64_t now = NowMicroseconds();
+  int64_t last = last_acquire_us_.exchange(now);
+  if (last > 0) {
+    // An exponential moving average with a weight of 1/8.
+    int64_t interval = acquire_interval_us_.load();
+    acquire_interval_us_.store(interval + (now - last - interval) / 8);
+  }
+
+  size_t size = size_.load();
+  size_t start = last_index_.load();
+  for (size_t index = 0; index < size; index++) {
+    size_t current = (index + start) % size;
     BufferUnit* buffer = pool_[current].get();
     if (buffer->MarkInUse()) {
-      last_index_ = current;
+      last_index_.store(current);
+      // The unit may have been in use when the pool was last prepared.
+      buffer->Reset(width_.load(), height_.load());
+      RecordAcquired();
       return buffer;
     }
   }
+  BufferUnit* buffer = Grow();
+  if (buffer) {
+    RecordAcquired();
+    return buffer;
+  }
+  exhausted_++;
   return nullptr;
 }
 
-void BufferPool::Release(BufferUnit* buffer) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  buffer->UnmarkInUse();
+BufferUnit* BufferPool::GetAvailableBuffer(int32_t width, int32_t height) {
+  width_.store(width);
+  height_.store(height);
+  BufferUnit* buffer = GetAvailableBuffer();
+  if (buffer && !buffer->Reset(width, height)) {
+    Release(buffer);
+    return nullptr;
+  }
+  return buffer;
 }
 
+void BufferPool::Release(BufferUnit* buffer) { buffer->UnmarkInUse(); }
+
 void BufferPool::Prepare(int32_t width, int32_t height) {
   std::lock_guard<std::mutex> lock(mutex_);
-  for (size_t index = 0; index < pool_.size(); index++) {
+  width_.store(width);
+  height_.store(height);
+  for (size_t index = 0; index < size_.load(); index++) {
+    // A unit in use is resized when it is next acquired instead, so that
+    // its surface stays valid for its user.
     BufferUnit* buffer = pool_[index].get();
-    buffer->Reset(width, height);
+    if (buffer->MarkInUse()) {
+      buffer->Reset(width, height);
+      buffer->UnmarkInUse();
+    }
   }
 }
 
-SingleBufferPool::SingleBufferPool(int32_t width, int32_t height)
-    : BufferPool(width, height, 1) {}
-
-SingleBufferPool::~SingleBufferPool() {}
+BufferPoolMetrics BufferPool::GetMetrics() const {
+  BufferPoolMetrics metrics;
+  metrics.size = size_.load();
+  metrics.min_size = min_size_;
+  metrics.max_size = pool_.size();
+  metrics.acquired = acquired_.load();
+  metrics.exhausted = exhausted_.load();
+  metrics.grown = grown_.load();
+  metrics.shrunk = shrunk_.load();
+  metrics.peak_in_use = peak_in_use_.load();
+  if (metrics.acquired > 0) {
+    metrics.average_in_use =
+        static_cast<double>(in_use_total_.load()) / metrics.acquired;
+  }
+  metrics.release_latency_us = release_latency_us_.load();
+  metrics.acquire_interval_us = acquire_interval_us_.load();
+  return metrics;
+}
 
-BufferUnit* SingleBufferPool::GetAvailableBuffer() {
+BufferUnit* BufferPool::Grow() {
   std::lock_guard<std::mutex> lock(mutex_);
-  BufferUnit* buffer = pool_[0].get();
-  if (buffer->MarkInUse()) {
-    return buffer;
+  size_t size = size_.load();
+  if (size >= pool_.size()) {
+    return nullptr;
   }
-  return nullptr;
+  // A unit removed by Shrink is still marked in use, so that no acquirer
+  // holding the old size can take it.
+  if (!pool_[size]) {
+    pool_[size] =
+        std::make_unique<BufferUnit>(0, 0, format_, use_external_buffer_);
+    pool_[size]->MarkInUse();
+  }
+  BufferUnit* buffer = pool_[size].get();
+  buffer->Reset(width_.load(), height_.load());
+  size_.store(size + 1);
+  grown_++;
+  return buffer;
 }
 
-void SingleBufferPool::Release(BufferUnit* buffer) {
-  BufferPool::Release(buffer);
+bool BufferPool::Shrink() {
+  size_t size = size_.load();
+  if (size <= min_size_) {
+    return false;
+  }
+  BufferUnit* buffer = pool_[size - 1].get();
+  if (!buffer->MarkInUse()) {
+    return false;
+  }
+  size_.store(size - 1);
+  // Free the surface but keep the unit, which may still be visited by an
+  // acquirer holding the old size.
+  buffer->Reset(0, 0);
+  shrunk_++;
+  return true;
 }
 
-#ifndef NDEBUG
-#include <cairo.h>
-void BufferUnit::DumpToPng(int file_name) {
-  char file_path[256];
-  sprintf(file_path, "/tmp/dump%d.png", file_name);
-
-  tbm_surface_info_s surface_info;
-  tbm_surface_map(tbm_surface_, TBM_SURF_OPTION_WRITE, &surface_info);
+void BufferPool::RecordAcquired() {
+  size_t in_use = 0;
+  size_t size = size_.load();
+  for (size_t index = 0; index < size; index++) {
+    if (pool_[index]->IsUsed()) {
+      in_use++;
+    }
+  }
+  acquired_++;
+  in_use_total_ += in_use;
+  size_t peak = peak_in_use_.load();
+  while (in_use > peak &&
+         !peak_in_use_.compare_exchange_weak(peak, in_use)) {
+  }
+  peak = window_peak_in_use_.load();
+  while (in_use > peak &&
+         !window_peak_in_use_.compare_exchange_weak(peak, in_use)) {
+  }
+  if (++window_acquired_ >= kAdaptWindow) {
+    Adapt();
+  }
+}
 
-  unsigned char* buffer = surface_info.planes[0].ptr;
-  cairo_surface_t* png_buffer = cairo_image_surface_create_for_data(
-      buffer, CAIRO_FORMAT_ARGB32, width_, height_,
-      surface_info.planes[0].stride);
+void BufferPool::Adapt() {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  window_acquired_.store(0);
+  size_t window_peak = window_peak_in_use_.exchange(0);
+  int64_t latency = 0;
+  for (const auto& buffer : pool_) {
+    if (buffer) {
+      latency = std::max(latency, buffer->TakeReleaseLatency());
+    }
+  }
+  release_latency_us_.store(latency);
+  if (pool_.size() <= min_size_) {
+    return;
+  }
 
-  cairo_surface_write_to_png(png_buffer, file_path);
+  // One unit is written by the producer, one waits for the engine and the
+  // others cover the time the engine holds a unit.
+  size_t target = 2;
+  int64_t interval = acquire_interval_us_.load();
+  if (interval > 0) {
+    target += static_cast<size_t>((latency + interval - 1) / interval);
+  }
+  target = std::clamp(target, min_size_, pool_.size());
+
+  size_t size = size_.load();
+  if (size < target) {
+    lock.unlock();
+    BufferUnit* buffer = Grow();
+    if (buffer) {
+      Release(buffer);
+    }
+  } else if (size > target && window_peak < size) {
+    Shrink();
+  }
+}
 
-  tbm_surface_unmap(tbm_surface_);
-  cairo_surface_destroy(png_buffer);
+bool BufferPool::IsFormatSupported(tbm_format format) {
+  uint32_t* formats = nullptr;
+  uint32_t count = 0;
+  if (tbm_surface_query_formats(&formats, &count) != TBM_SURFACE_ERROR_NONE) {
+    return false;
+  }
+  bool supported = false;
+  for (uint32_t index = 0; index < count; index++) {
+    if (formats[index] == format) {
+      supported = true;
+      break;
+    }
+  }
+  free(formats);
+  return supported;
 }
-#endif
+
+SingleBufferPool::SingleBufferPool(int32_t width, int32_t height,
+                                   tbm_format format)
+    : BufferPool(width, height, 1, format) {}
+
+SingleBufferPool::~SingleBufferPool() {}
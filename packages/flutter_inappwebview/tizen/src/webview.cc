@@ -23,6 +23,10 @@ struct WebViewLifetimeState {
 
 namespace {
 
+// The pool grows up to the maximum while the engine holds units longer than
+// the interval between frames.
+constexpr size_t kMinBufferPoolSize = 1;
+constexpr size_t kMaxBufferPoolSize = 3;
 constexpr char kInAppWebViewChannelName[] =
     "com.pichillilorenzo/flutter_inappwebview_";
 constexpr int kConsoleMessageLog = 1;
@@ -244,7 +248,10 @@ WebView::WebView(flutter::PluginRegistrar* registrar, int view_id,
     return;
   }
 
-  tbm_pool_ = std::make_unique<SingleBufferPool>(width, height);
+  // The units refer to the surfaces rendered by the engine.
+  tbm_pool_ = std::make_unique<BufferPool>(width, height, kMinBufferPoolSize,
+                                           kMaxBufferPoolSize,
+                                           TBM_FORMAT_ARGB8888, true);
 
   texture_variant_ =
       std::make_unique<flutter::TextureVariant>(flutter::GpuSurfaceTexture(
@@ -395,7 +402,10 @@ void WebView::Resize(double width, double height) {
       tbm_pool_->Release(candidate_surface_);
       candidate_surface_ = nullptr;
     }
-    rendered_surface_ = nullptr;
+    if (rendered_surface_) {
+      tbm_pool_->Release(rendered_surface_);
+      rendered_surface_ = nullptr;
+    }
     tbm_pool_->Prepare(width_, height_);
   }
 
@@ -949,6 +959,9 @@ void WebView::HandleWebViewMethodCall(const FlMethodCall& method_call,
     EwkInternalApiBinding::GetInstance().view.JavaScriptPromptReply(
         webview_instance_, value ? value->c_str() : nullptr);
     result->Success();
+  } else if (method_name == "getBufferPoolMetrics") {
+    result->Success(
+        flutter::EncodableValue(tbm_pool_->GetMetrics().ToEncodableMap()));
   } else {
     result->NotImplemented();
   }
@@ -957,17 +970,18 @@ void WebView::HandleWebViewMethodCall(const FlMethodCall& method_call,
 FlutterDesktopGpuSurfaceDescriptor* WebView::ObtainGpuSurface(size_t width,
                                                               size_t height) {
   std::lock_guard<std::mutex> lock(mutex_);
-  if (!candidate_surface_) {
+  if (candidate_surface_) {
+    // The rendered surface stays in use while it is displayed, and goes back
+    // to the pool when the engine releases its last descriptor.
     if (rendered_surface_) {
-      if (!rendered_surface_->MarkInUse()) {
-        return nullptr;
-      }
-      return rendered_surface_->GpuSurface();
+      tbm_pool_->Release(rendered_surface_);
     }
+    rendered_surface_ = candidate_surface_;
+    candidate_surface_ = nullptr;
+  }
+  if (!rendered_surface_) {
     return nullptr;
   }
-  rendered_surface_ = candidate_surface_;
-  candidate_surface_ = nullptr;
   return rendered_surface_->GpuSurface();
 }
 
@@ -985,7 +999,6 @@ void WebView::OnFrameRendered(void* data, Evas_Object* obj, void* event_info) {
       if (!webview->working_surface_) {
         return;
       }
-      webview->working_surface_->UseExternalBuffer();
     }
     webview->working_surface_->SetExternalBuffer(
         static_cast<tbm_surface_h>(event_info));
@@ -0,0 +1,158 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file is shared by the plugins that render into pooled tbm surfaces
+// (webview_flutter, webview_flutter_lwe, flutter_inappwebview and
+// flutter_webrtc). Keep the copies identical, as checked by
+// tools/check_shared_sources.sh.
+
+#ifndef FLUTTER_PLUGIN_BUFFER_POOL_H_
+#define FLUTTER_PLUGIN_BUFFER_POOL_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter_texture_registrar.h>
+#include <tbm_surface.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct BufferReleaseState;
+
+class BufferUnit {
+ public:
+  // A unit that uses an external buffer never creates a surface, and only
+  // refers to the one set by SetExternalBuffer.
+  explicit BufferUnit(int32_t width, int32_t height,
+                      tbm_format format = TBM_FORMAT_ARGB8888,
+                      bool use_external_buffer = false);
+  ~BufferUnit();
+
+  // Recreates the surface if the size has changed. Returns false if there is
+  // no surface afterwards.
+  bool Reset(int32_t width, int32_t height);
+
+  // Takes the unit if no one uses it. Returns false otherwise.
+  bool MarkInUse();
+  // Gives up the use taken by MarkInUse.
+  void UnmarkInUse();
+
+  bool IsUsed();
+
+  // Returns the longest time the engine held a descriptor of this unit since
+  // the last call, in microseconds.
+  int64_t TakeReleaseLatency();
+
+  void SetExternalBuffer(tbm_surface_h tbm_surface);
+
+  tbm_surface_h Surface();
+
+  // Returns a new descriptor of the surface for the engine, which must be
+  // called by a user of the unit. The descriptor is another use of the unit,
+  // given up when the engine releases it, even if the unit has been
+  // destroyed in the meantime.
+  FlutterDesktopGpuSurfaceDescriptor* GpuSurface();
+
+ private:
+  std::shared_ptr<BufferReleaseState> release_state_;
+  const bool use_external_buffer_;
+  tbm_format format_;
+  int32_t width_ = 0;
+  int32_t height_ = 0;
+  // Replaced by Reset and SetExternalBuffer while other threads may read it.
+  std::atomic<tbm_surface_h> tbm_surface_ = nullptr;
+};
+
+struct BufferPoolMetrics {
+  // The current number of units and the bounds it adapts between.
+  size_t size = 0;
+  size_t min_size = 0;
+  size_t max_size = 0;
+  // The number of GetAvailableBuffer calls that returned a unit.
+  uint64_t acquired = 0;
+  // The number of GetAvailableBuffer calls that found every unit in use.
+  uint64_t exhausted = 0;
+  // The number of units added and removed by adaptation.
+  uint64_t grown = 0;
+  uint64_t shrunk = 0;
+  // The highest and the average number of units in use right after a unit
+  // has been acquired.
+  size_t peak_in_use = 0;
+  double average_in_use = 0.0;
+  // The longest time the engine held a unit during the last adaptation
+  // window, and the average interval between acquisitions, in microseconds.
+  int64_t release_latency_us = 0;
+  int64_t acquire_interval_us = 0;
+
+  // Returns the metrics keyed by their camelCase names, as reported to Dart.
+  flutter::EncodableMap ToEncodableMap() const;
+};
+
+class BufferPool {
+ public:
+  explicit BufferPool(int32_t width, int32_t height, size_t pool_size,
+                      tbm_format format = TBM_FORMAT_ARGB8888);
+  // Creates a pool of |min_pool_size| units that grows up to
+  // |max_pool_size| units when every unit is in use or the engine holds
+  // units longer than the producer's frame interval, and shrinks back when
+  // units stay idle. If |use_external_buffer| is true, the units do not
+  // create surfaces.
+  explicit BufferPool(int32_t width, int32_t height, size_t min_pool_size,
+                      size_t max_pool_size, tbm_format format,
+                      bool use_external_buffer = false);
+  virtual ~BufferPool();
+
+  // Acquiring and releasing units is lock-free and can be done from any
+  // thread.
+  BufferUnit* GetAvailableBuffer();
+  // Same as above, but resizes the acquired unit to the given size.
+  BufferUnit* GetAvailableBuffer(int32_t width, int32_t height);
+  void Release(BufferUnit* buffer);
+
+  // Resizes the units that are not in use.
+  void Prepare(int32_t with, int32_t height);
+
+  BufferPoolMetrics GetMetrics() const;
+
+  static bool IsFormatSupported(tbm_format format);
+
+ private:
+  BufferUnit* Grow();
+  bool Shrink();
+  void RecordAcquired();
+  void Adapt();
+
+  // Sized to the maximum pool size. Only the first |size_| units are in the
+  // pool, the others are created on demand.
+  std::vector<std::unique_ptr<BufferUnit>> pool_;
+  std::atomic<size_t> size_ = 0;
+  size_t min_size_;
+  tbm_format format_;
+  bool use_external_buffer_;
+  std::atomic<int32_t> width_;
+  std::atomic<int32_t> height_;
+  std::atomic<size_t> last_index_ = 0;
+  std::atomic<uint64_t> acquired_ = 0;
+  std::atomic<uint64_t> exhausted_ = 0;
+  std::atomic<uint64_t> grown_ = 0;
+  std::atomic<uint64_t> shrunk_ = 0;
+  std::atomic<uint64_t> in_use_total_ = 0;
+  std::atomic<size_t> peak_in_use_ = 0;
+  std::atomic<int64_t> last_acquire_us_ = 0;
+  std::atomic<int64_t> acquire_interval_us_ = 0;
+  std::atomic<int64_t> release_latency_us_ = 0;
+  std::atomic<uint64_t> window_acquired_ = 0;
+  std::atomic<size_t> window_peak_in_use_ = 0;
+  std::mutex mutex_;
+};
+
+class SingleBufferPool : public BufferPool {
+ public:
+  explicit SingleBufferPool(int32_t width, int32_t height,
+                            tbm_format format = TBM_FORMAT_ARGB8888);
+  ~SingleBufferPool();
+};
+
+#endif  // FLUTTER_PLUGIN_BUFFER_POOL_H_
@@ -10,6 +10,7 @@
 #include <flutter/standard_method_codec.h>
 #include <flutter/texture_registrar.h>
 
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -181,6 +182,13 @@ class EventChannelProxy {
 
   virtual void Success(const EncodableValue& event,
                        bool cache_event = true) = 0;
+
+  // Same as above, but moves |event| to the main thread without copying it.
+  virtual void Success(EncodableValue&& event, bool cache_event = true) = 0;
+
+  // Sets a callback that is called on the main thread when Dart starts
+  // listening, after the cached events have been sent.
+  virtual void SetOnListen(std::function<void()> on_listen) = 0;
 };
 
 #endif  // FLUTTER_WEBRTC_COMMON_HXX
@@ -3,7 +3,10 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <list>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include "flutter_common.h"
 #include "flutter_webrtc_base.h"
@@ -14,26 +17,75 @@ namespace flutter_webrtc_plugin {
 
 using namespace libwebrtc;
 
+struct FrameCaptureOptions {
+  // The file to save the frame to. If empty, the encoded frame is returned
+  // as the result instead.
+  std::string path;
+  // Whether to encode the frame as JPEG with |quality| rather than as PNG.
+  bool jpeg = false;
+  int quality = 90;
+  // The maximum size of the captured image, or 0 for no limit. The frame is
+  // scaled down to fit with the same aspect ratio.
+  int max_width = 0;
+  int max_height = 0;
+};
+
 class FlutterFrameCapturer
     : public RTCVideoRenderer<scoped_refptr<RTCVideoFrame>> {
  public:
-  FlutterFrameCapturer(RTCVideoTrack* track, std::string path);
+  FlutterFrameCapturer(scoped_refptr<RTCVideoTrack> track,
+                       const FrameCaptureOptions& options);
 
   virtual void OnFrame(scoped_refptr<RTCVideoFrame> frame) override;
 
-  void CaptureFrame(std::unique_ptr<MethodResultProxy> result);
+  // Makes a pending WaitForFrame return without a frame.
+  void Cancel();
 
  private:
-  RTCVideoTrack* track_;
-  std::string path_;
+  friend class FrameCaptureGroup;
+
+  scoped_refptr<RTCVideoFrame> WaitForFrame();
+
+  bool EncodeFrame(scoped_refptr<RTCVideoFrame> frame,
+                   std::vector<uint8_t>* encoded);
+
+  scoped_refptr<RTCVideoTrack> track_;
+  FrameCaptureOptions options_;
   std::mutex mutex_;
   std::condition_variable cv_;
   scoped_refptr<RTCVideoFrame> frame_;
-  std::atomic<bool> catch_frame_;
+  bool cancelled_ = false;
+};
+
+// Runs frame captures on worker threads. The captures still running are
+// cancelled and joined on destruction, which must happen before libwebrtc
+// is terminated. Only used on the platform thread.
+class FrameCaptureGroup {
+ public:
+  FrameCaptureGroup() = default;
+  ~FrameCaptureGroup();
+
+  // Waits for the next frame of |track| and encodes it on a worker thread,
+  // so the calling thread is not blocked. The result is reported on the
+  // platform thread unless the group has been destroyed by then.
+  void CaptureFrame(scoped_refptr<RTCVideoTrack> track,
+                    const FrameCaptureOptions& options,
+                    std::unique_ptr<MethodResultProxy> result);
+
+ private:
+  struct Worker {
+    std::unique_ptr<FlutterFrameCapturer> capturer;
+    std::thread thread;
+    std::atomic<bool> finished = false;
+  };
+
+  // Joins the workers which have finished.
+  void JoinFinished();
 
-  bool SaveFrame();
+  std::list<std::unique_ptr<Worker>> workers_;
+  std::shared_ptr<bool> is_alive_ = std::make_shared<bool>(true);
 };
 
 }  // namespace flutter_webrtc_plugin
 
-#endif  // !FLUTTER_WEBRTC_RTC_FRAME_CAPTURER_HXX
\ No newline at end of file
+#endif  // !FLUTTER_WEBRTC_RTC_FRAME_CAPTURER_HXX
@@ -1,7 +1,10 @@
 #ifndef FLUTTER_WEBRTC_RTC_PEER_CONNECTION_HXX
 #define FLUTTER_WEBRTC_RTC_PEER_CONNECTION_HXX
 
+#include <set>
+
 #include "flutter_common.h"
+#include "flutter_frame_capturer.h"
 #include "flutter_webrtc_base.h"
 
 namespace flutter_webrtc_plugin {
@@ -129,7 +132,7 @@ class FlutterPeerConnection {
                         const EncodableMap& configuration,
                         std::unique_ptr<MethodResultProxy> result);
 
-  void CaptureFrame(RTCVideoTrack* track, std::string path,
+  void CaptureFrame(RTCVideoTrack* track, const FrameCaptureOptions& options,
                     std::unique_ptr<MethodResultProxy> result);
 
   scoped_refptr<RTCRtpTransceiver> getRtpTransceiverById(RTCPeerConnection* pc,
@@ -153,6 +156,16 @@ class FlutterPeerConnection {
   void GetStats(const std::string& track_id, RTCPeerConnection* pc,
                 std::unique_ptr<MethodResultProxy> result);
 
+  // Sends the stats of |pc| that have changed every |interval_ms| to the
+  // "FlutterWebRTC/statsEvent<uuid>" event channel. Only the reports whose
+  // type is in |types| are sent, or all reports if |types| is empty.
+  void SubscribeStats(RTCPeerConnection* pc, const std::string& uuid,
+                      uint32_t interval_ms, std::set<std::string> types,
+                      std::unique_ptr<MethodResultProxy> result);
+
+  void UnsubscribeStats(const std::string& uuid,
+                        std::unique_ptr<MethodResultProxy> result);
+
   void MediaStreamAddTrack(scoped_refptr<RTCMediaStream> stream,
                            scoped_refptr<RTCMediaTrack> track,
                            std::unique_ptr<MethodResultProxy> result);
@@ -184,6 +197,10 @@ const char* peerConnectionStateString(RTCPeerConnectionState state);
 
 const char* iceGatheringStateString(RTCIceGatheringState state);
 
+// Returns the value of |member|, or a null value if its type is not
+// supported.
+EncodableValue statsMemberToValue(const scoped_refptr<RTCStatsMember>& member);
+
 }  // namespace flutter_webrtc_plugin
 
 #endif  // !FLUTTER_WEBRTC_RTC_PEER_CONNECTION_HXX
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef FLUTTER_WEBRTC_RTC_STATS_SUBSCRIPTION_HXX
+#define FLUTTER_WEBRTC_RTC_STATS_SUBSCRIPTION_HXX
+
+#include <glib.h>
+
+#include <memory>
+#include <set>
+
+#include "flutter_common.h"
+#include "flutter_webrtc_base.h"
+
+namespace flutter_webrtc_plugin {
+
+// Samples the stats of a peer connection on a timer and sends only what has
+// changed since the previous sample to an event channel, so that monitoring
+// costs scale with the amount of change rather than with the report size.
+//
+// Each event is a map with:
+//  - "event": "statsUpdated"
+//  - "reports": the reports that are new or have changed, each with "id",
+//    "type", "timestamp" and the changed "values".
+//  - "removed": the IDs of the reports that are gone.
+// The first event after the stream is listened to contains every report in
+// full.
+class FlutterStatsSubscription {
+ public:
+  // Samples every |interval_ms| the reports of |pc| whose type is in
+  // |types|, or all reports if |types| is empty.
+  FlutterStatsSubscription(scoped_refptr<RTCPeerConnection> pc,
+                           BinaryMessenger* messenger, TaskRunner* task_runner,
+                           const std::string& channel_name,
+                           uint32_t interval_ms, std::set<std::string> types);
+  ~FlutterStatsSubscription();
+
+ private:
+  struct State;
+
+  static gboolean OnTimeout(gpointer data);
+
+  std::shared_ptr<State> state_;
+  std::shared_ptr<EventChannelProxy> event_channel_;
+  guint timer_id_ = 0;
+};
+
+}  // namespace flutter_webrtc_plugin
+
+#endif  // !FLUTTER_WEBRTC_RTC_STATS_SUBSCRIPTION_HXX
@@ -1,8 +1,10 @@
 #ifndef FLUTTER_WEBRTC_RTC_VIDEO_RENDERER_HXX
 #define FLUTTER_WEBRTC_RTC_VIDEO_RENDERER_HXX
 
+#include <atomic>
 #include <mutex>
 
+#include "buffer_pool.h"
 #include "flutter_common.h"
 #include "flutter_webrtc_base.h"
 #include "rtc_video_frame.h"
@@ -24,15 +26,34 @@ class FlutterVideoRenderer
                   std::unique_ptr<flutter::TextureVariant> texture,
                   int64_t texture_id);
 
+  // Switches the renderer to upload I420 frames into pooled tbm surfaces.
+  // Returns false if the platform cannot create such surfaces, in which case
+  // the pixel buffer path must be used.
+  bool InitGpuSurface();
+
   virtual const FlutterDesktopPixelBuffer* CopyPixelBuffer(size_t width,
                                                            size_t height) const;
 
+  const FlutterDesktopGpuSurfaceDescriptor* ObtainGpuSurface(size_t width,
+                                                             size_t height);
+
   virtual void OnFrame(scoped_refptr<RTCVideoFrame> frame) override;
 
   void SetVideoTrack(scoped_refptr<RTCVideoTrack> track);
 
   int64_t texture_id() { return texture_id_; }
 
+  struct FrameStats {
+    // Frames converted or uploaded for the engine.
+    uint64_t converted;
+    // Frames replaced by a newer one before the engine pulled them.
+    uint64_t dropped;
+    // Engine pulls answered with the previously converted frame.
+    uint64_t reused;
+  };
+
+  FrameStats frame_stats() const;
+
   bool CheckMediaStream(std::string mediaId);
 
   bool CheckVideoTrack(std::string mediaId);
@@ -40,6 +61,8 @@ class FlutterVideoRenderer
   std::string media_stream_id;
 
  private:
+  bool UploadFrame(const scoped_refptr<RTCVideoFrame>& frame);
+
   struct FrameSize {
     size_t width;
     size_t height;
@@ -50,12 +73,21 @@ class FlutterVideoRenderer
   std::unique_ptr<EventChannelProxy> event_channel_;
   int64_t texture_id_ = -1;
   scoped_refptr<RTCVideoTrack> track_ = nullptr;
-  scoped_refptr<RTCVideoFrame> frame_;
+  // The latest frame not yet pulled by the engine.
+  mutable scoped_refptr<RTCVideoFrame> frame_;
   std::unique_ptr<flutter::TextureVariant> texture_;
-  std::shared_ptr<FlutterDesktopPixelBuffer> pixel_buffer_;
-  mutable std::shared_ptr<uint8_t> rgb_buffer_;
+  // Only accessed on the raster thread.
+  mutable FlutterDesktopPixelBuffer pixel_buffer_ = {};
+  mutable std::unique_ptr<uint8_t[]> rgb_buffer_;
+  mutable size_t rgb_buffer_size_ = 0;
   mutable std::mutex mutex_;
+  mutable std::atomic<uint64_t> frames_converted_ = 0;
+  mutable std::atomic<uint64_t> frames_dropped_ = 0;
+  mutable std::atomic<uint64_t> frames_reused_ = 0;
   RTCVideoFrame::VideoRotation rotation_ = RTCVideoFrame::kVideoRotation_0;
+  std::unique_ptr<BufferPool> buffer_pool_;
+  BufferUnit* candidate_buffer_ = nullptr;
+  BufferUnit* rendered_buffer_ = nullptr;
 };
 
 class FlutterVideoRendererManager {
@@ -72,6 +104,9 @@ class FlutterVideoRendererManager {
   void VideoRendererDispose(int64_t texture_id,
                             std::unique_ptr<MethodResultProxy> result);
 
+  void VideoRendererGetFrameStats(int64_t texture_id,
+                                  std::unique_ptr<MethodResultProxy> result);
+
  private:
   FlutterWebRTCBase* base_;
   std::map<int64_t, scoped_refptr<FlutterVideoRenderer>> renderers_;
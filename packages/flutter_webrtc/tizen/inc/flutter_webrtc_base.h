@@ -28,6 +28,8 @@ using namespace libwebrtc;
 class FlutterVideoRenderer;
 class FlutterRTCDataChannelObserver;
 class FlutterPeerConnectionObserver;
+class FlutterStatsSubscription;
+class FrameCaptureGroup;
 
 class FlutterWebRTCBase {
  public:
@@ -118,6 +120,8 @@ class FlutterWebRTCBase {
       data_channel_observers_;
   std::map<std::string, std::shared_ptr<FlutterPeerConnectionObserver>>
       peerconnection_observers_;
+  std::map<std::string, std::shared_ptr<FlutterStatsSubscription>>
+      stats_subscriptions_;
   mutable std::mutex mutex_;
 
   void lock() { mutex_.lock(); }
@@ -128,6 +132,8 @@ class FlutterWebRTCBase {
   TaskRunner* task_runner_;
   TextureRegistrar* textures_;
   std::unique_ptr<EventChannelProxy> event_channel_;
+  // Stopped on destruction before libwebrtc is terminated.
+  std::unique_ptr<FrameCaptureGroup> frame_captures_;
 };
 
 }  // namespace flutter_webrtc_plugin
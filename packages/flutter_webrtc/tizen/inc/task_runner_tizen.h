@@ -6,11 +6,30 @@
 
 #include <glib.h>
 
-#include <mutex>
-#include <queue>
+#include <cstdint>
+#include <memory>
 
 #include "task_runner.h"
 
+struct TaskRunnerStats {
+  // The number of tasks waiting to run, and the most that have waited at
+  // once.
+  size_t queue_depth = 0;
+  size_t max_queue_depth = 0;
+  uint64_t enqueued = 0;
+  uint64_t run = 0;
+  // The number of main loop wakeups that ran tasks.
+  uint64_t wakeups = 0;
+  // The average and the longest time from enqueueing a task to running it,
+  // in microseconds.
+  int64_t average_latency_us = 0;
+  int64_t max_latency_us = 0;
+};
+
+// Runs tasks on the main thread. Tasks enqueued before the main loop wakes
+// up are run in order in a single wakeup, without holding the lock, so that
+// they can enqueue more tasks and other threads are not blocked while they
+// run.
 class TaskRunnerTizen : public TaskRunner {
  public:
   TaskRunnerTizen();
@@ -18,10 +37,15 @@ class TaskRunnerTizen : public TaskRunner {
 
   void EnqueueTask(TaskClosure task) override;
 
+  TaskRunnerStats GetStats() const;
+
  private:
-  static gboolean RunTask(gpointer data);
-  std::mutex tasks_mutex_;
-  std::queue<TaskClosure> tasks_;
+  struct TaskQueue;
+
+  static gboolean RunTasks(gpointer data);
+
+  // Shared with the pending main loop source, which may outlive the runner.
+  std::shared_ptr<TaskQueue> queue_;
 };
 
-#endif  // PACKAGES_FLUTTER_WEBRTC_TASK_RUNNER_TIZEN_H_
\ No newline at end of file
+#endif  // PACKAGES_FLUTTER_WEBRTC_TASK_RUNNER_TIZEN_H_
@@ -1,7 +1,9 @@
 #include "flutter_common.h"
 
 #include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include "task_runner.h"
 
@@ -76,6 +78,7 @@ class EventChannelProxyImpl : public EventChannelProxy {
       : channel_(std::make_unique<EventChannel>(
             messenger, channelName,
             &flutter::StandardMethodCodec::GetInstance())),
+        channel_name_(channelName),
         task_runner_(task_runner) {
     auto handler = std::make_unique<
         flutter::StreamHandlerFunctions<EncodableValue>>(
@@ -85,10 +88,13 @@ class EventChannelProxyImpl : public EventChannelProxy {
           sink_ = std::move(events);
           std::weak_ptr<EventSink> weak_sink = sink_;
           for (auto& event : event_queue_) {
-            PostEvent(event);
+            PostEvent(std::move(event));
           }
           event_queue_.clear();
           on_listen_called_ = true;
+          if (on_listen_) {
+            on_listen_();
+          }
           return nullptr;
         },
         [&](const EncodableValue* arguments)
@@ -97,25 +103,44 @@ class EventChannelProxyImpl : public EventChannelProxy {
           return nullptr;
         });
 
+    std::lock_guard<std::mutex> lock(OwnersMutex());
     channel_->SetStreamHandler(std::move(handler));
+    Owners()[channel_name_] = this;
   }
 
-  virtual ~EventChannelProxyImpl() {}
+  virtual ~EventChannelProxyImpl() {
+    // The handler refers to this object, but a newer proxy for the same
+    // channel may have replaced it, in which case it must be kept.
+    std::lock_guard<std::mutex> lock(OwnersMutex());
+    auto owner = Owners().find(channel_name_);
+    if (owner != Owners().end() && owner->second == this) {
+      channel_->SetStreamHandler(nullptr);
+      Owners().erase(owner);
+    }
+  }
 
   void Success(const EncodableValue& event, bool cache_event = true) override {
+    Success(EncodableValue(event), cache_event);
+  }
+
+  void Success(EncodableValue&& event, bool cache_event = true) override {
     if (on_listen_called_) {
-      PostEvent(event);
+      PostEvent(std::move(event));
     } else {
       if (cache_event) {
-        event_queue_.push_back(event);
+        event_queue_.push_back(std::move(event));
       }
     }
   }
 
-  void PostEvent(const EncodableValue& event) {
+  void SetOnListen(std::function<void()> on_listen) override {
+    on_listen_ = std::move(on_listen);
+  }
+
+  void PostEvent(EncodableValue event) {
     if (task_runner_) {
       std::weak_ptr<EventSink> weak_sink = sink_;
-      task_runner_->EnqueueTask([weak_sink, event]() {
+      task_runner_->EnqueueTask([weak_sink, event = std::move(event)]() {
         auto sink = weak_sink.lock();
         if (sink) {
           sink->Success(event);
@@ -127,10 +152,23 @@ class EventChannelProxyImpl : public EventChannelProxy {
   }
 
  private:
+  // The proxy whose handler is registered for each channel name. Data
+  // channel proxies are created on a libwebrtc thread.
+  static std::map<std::string, EventChannelProxyImpl*>& Owners() {
+    static std::map<std::string, EventChannelProxyImpl*> owners;
+    return owners;
+  }
+  static std::mutex& OwnersMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
   std::unique_ptr<EventChannel> channel_;
+  std::string channel_name_;
   std::shared_ptr<flutter::EventSink<flutter::EncodableValue>> sink_;
   std::list<EncodableValue> event_queue_;
   std::atomic<bool> on_listen_called_ = false;
+  std::function<void()> on_listen_;
   TaskRunner* task_runner_;
 };
 
@@ -69,15 +69,20 @@ void FlutterDataChannel::CreateDataChannel(
 void FlutterDataChannel::DataChannelSend(
     RTCDataChannel* data_channel, const std::string& type,
     const EncodableValue& data, std::unique_ptr<MethodResultProxy> result) {
+  // Sends the data straight from the decoded method call without copying it.
   bool is_binary = type == "binary";
-  if (is_binary && TypeIs<std::vector<uint8_t>>(data)) {
-    std::vector<uint8_t> buffer = GetValue<std::vector<uint8_t>>(data);
-    data_channel->Send(buffer.data(), static_cast<uint32_t>(buffer.size()),
+  const auto* buffer = std::get_if<std::vector<uint8_t>>(&data);
+  const auto* str = std::get_if<std::string>(&data);
+  if (is_binary && buffer) {
+    data_channel->Send(buffer->data(), static_cast<uint32_t>(buffer->size()),
                        true);
+  } else if (str) {
+    data_channel->Send(reinterpret_cast<const uint8_t*>(str->c_str()),
+                       static_cast<uint32_t>(str->length()), false);
   } else {
-    std::string str = GetValue<std::string>(data);
-    data_channel->Send(reinterpret_cast<const uint8_t*>(str.c_str()),
-                       static_cast<uint32_t>(str.length()), false);
+    result->Error("dataChannelSendFailed",
+                  "dataChannelSend() data is not a string or bytes");
+    return;
   }
   result->Success();
 }
@@ -141,12 +146,11 @@ void FlutterRTCDataChannelObserver::OnMessage(const char* buffer, int length,
 
   params[EncodableValue("id")] = EncodableValue(data_channel_->id());
   params[EncodableValue("type")] = EncodableValue(binary ? "binary" : "text");
-  std::string str(buffer, length);
+  // The message is copied once here and then moved up to the event sink.
   params[EncodableValue("data")] =
-      binary ? EncodableValue(std::vector<uint8_t>(str.begin(), str.end()))
-             : EncodableValue(str);
+      binary ? EncodableValue(std::vector<uint8_t>(buffer, buffer + length))
+             : EncodableValue(std::string(buffer, length));
 
-  auto data = EncodableValue(params);
-  event_channel_->Success(data);
+  event_channel_->Success(EncodableValue(std::move(params)));
 }
 }  // namespace flutter_webrtc_plugin
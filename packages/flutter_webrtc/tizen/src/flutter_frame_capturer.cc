@@ -4,83 +4,234 @@
 
 #include "flutter_frame_capturer.h"
 
+#include <glib.h>
+#include <image_util.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#include <vector>
+#include <algorithm>
+#include <thread>
 
+#include "log.h"
 #include "svpng.hpp"
 
 namespace flutter_webrtc_plugin {
 
-FlutterFrameCapturer::FlutterFrameCapturer(RTCVideoTrack* track,
-                                           std::string path) {
-  track_ = track;
-  path_ = path;
+namespace {
+
+bool EncodePng(const std::vector<uint8_t>& pixels, int width, int height,
+               const std::string& path, std::vector<uint8_t>* encoded) {
+  if (!path.empty()) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    svpng(file, width, height, pixels.data(), 1);
+    fclose(file);
+    return true;
+  }
+
+  char* buffer = nullptr;
+  size_t size = 0;
+  FILE* stream = open_memstream(&buffer, &size);
+  if (!stream) {
+    return false;
+  }
+  svpng(stream, width, height, pixels.data(), 1);
+  fclose(stream);
+  encoded->assign(buffer, buffer + size);
+  free(buffer);
+  return true;
 }
 
+bool EncodeJpeg(const std::vector<uint8_t>& pixels, int width, int height,
+                int quality, const std::string& path,
+                std::vector<uint8_t>* encoded) {
+  image_util_image_h image = nullptr;
+  int ret = image_util_create_image(width, height,
+                                    IMAGE_UTIL_COLORSPACE_RGBA8888,
+                                    pixels.data(), pixels.size(), &image);
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("image_util_create_image failed: %s", get_error_message(ret));
+    return false;
+  }
+
+  image_util_encode_h handle = nullptr;
+  ret = image_util_encode_create(IMAGE_UTIL_JPEG, &handle);
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("image_util_encode_create failed: %s", get_error_message(ret));
+    image_util_destroy_image(image);
+    return false;
+  }
+
+  ret = image_util_encode_set_quality(handle, std::clamp(quality, 1, 100));
+  if (ret == IMAGE_UTIL_ERROR_NONE) {
+    if (!path.empty()) {
+      ret = image_util_encode_run_to_file(handle, image, path.c_str());
+    } else {
+      unsigned char* buffer = nullptr;
+      size_t size = 0;
+      ret = image_util_encode_run_to_buffer(handle, image, &buffer, &size);
+      if (ret == IMAGE_UTIL_ERROR_NONE) {
+        encoded->assign(buffer, buffer + size);
+        free(buffer);
+      }
+    }
+  }
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("Failed to encode the frame: %s", get_error_message(ret));
+  }
+
+  image_util_encode_destroy(handle);
+  image_util_destroy_image(image);
+  return ret == IMAGE_UTIL_ERROR_NONE;
+}
+
+}  // namespace
+
+FlutterFrameCapturer::FlutterFrameCapturer(scoped_refptr<RTCVideoTrack> track,
+                                           const FrameCaptureOptions& options)
+    : track_(track), options_(options) {}
+
 void FlutterFrameCapturer::OnFrame(scoped_refptr<RTCVideoFrame> frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (frame_ != nullptr) {
     return;
   }
 
   frame_ = frame.get()->Copy();
-  catch_frame_ = true;
   cv_.notify_one();
 }
 
-void FlutterFrameCapturer::CaptureFrame(
-    std::unique_ptr<MethodResultProxy> result) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  // Here init catch_frame_ flag
-  catch_frame_ = false;
-  frame_ = nullptr;
+void FlutterFrameCapturer::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cancelled_ = true;
+  cv_.notify_one();
+}
 
-  track_->AddRenderer(this);
+FrameCaptureGroup::~FrameCaptureGroup() {
+  *is_alive_ = false;
+  for (auto& worker : workers_) {
+    worker->capturer->Cancel();
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
 
-  // Wait for frame with timeout (5 seconds)
-  bool timeout = !cv_.wait_for(lock, std::chrono::seconds(5),
-                               [this] { return catch_frame_.load(); });
+void FrameCaptureGroup::CaptureFrame(
+    scoped_refptr<RTCVideoTrack> track, const FrameCaptureOptions& options,
+    std::unique_ptr<MethodResultProxy> result) {
+  JoinFinished();
 
-  track_->RemoveRenderer(this);
+  auto worker = std::make_unique<Worker>();
+  worker->capturer = std::make_unique<FlutterFrameCapturer>(track, options);
+  std::shared_ptr<MethodResultProxy> result_ptr(result.release());
+  Worker* current = worker.get();
+  worker->thread = std::thread([current, is_alive = is_alive_,
+                                result_ptr = std::move(result_ptr)]() mutable {
+    FlutterFrameCapturer* capturer = current->capturer.get();
+    scoped_refptr<RTCVideoFrame> frame = capturer->WaitForFrame();
+
+    std::vector<uint8_t> encoded;
+    std::function<void()> reply;
+    if (frame == nullptr) {
+      reply = [result_ptr = std::move(result_ptr)]() {
+        result_ptr->Error("2", "Frame capture timed out");
+      };
+    } else if (!capturer->EncodeFrame(frame, &encoded)) {
+      reply = [result_ptr = std::move(result_ptr)]() {
+        result_ptr->Error("1", "Cannot encode the frame");
+      };
+    } else if (capturer->options_.path.empty()) {
+      reply = [result_ptr = std::move(result_ptr),
+               encoded = std::move(encoded)]() mutable {
+        result_ptr->Success(EncodableValue(std::move(encoded)));
+      };
+    } else {
+      reply = [result_ptr = std::move(result_ptr)]() {
+        result_ptr->Success();
+      };
+    }
+
+    // The result is only used and released on the main thread, where the
+    // plugin is also destroyed.
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT,
+        [](gpointer data) -> gboolean {
+          (*static_cast<std::function<void()>*>(data))();
+          return G_SOURCE_REMOVE;
+        },
+        new std::function<void()>([is_alive, reply = std::move(reply)]() {
+          if (*is_alive) {
+            reply();
+          }
+        }),
+        [](gpointer data) {
+          delete static_cast<std::function<void()>*>(data);
+        });
+    current->finished = true;
+  });
+  workers_.push_back(std::move(worker));
+}
 
-  if (timeout) {
-    std::shared_ptr<MethodResultProxy> result_ptr(result.release());
-    result_ptr->Error("2", "Frame capture timed out");
-    return;
+void FrameCaptureGroup::JoinFinished() {
+  for (auto iter = workers_.begin(); iter != workers_.end();) {
+    if ((*iter)->finished) {
+      (*iter)->thread.join();
+      iter = workers_.erase(iter);
+    } else {
+      ++iter;
+    }
   }
+}
 
-  bool success = SaveFrame();
+scoped_refptr<RTCVideoFrame> FlutterFrameCapturer::WaitForFrame() {
+  track_->AddRenderer(this);
 
-  std::shared_ptr<MethodResultProxy> result_ptr(result.release());
-  if (success) {
-    result_ptr->Success();
-  } else {
-    result_ptr->Error("1", "Cannot save the frame as .png file");
+  scoped_refptr<RTCVideoFrame> frame;
+  {
+    // Wait for frame with timeout (5 seconds)
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, std::chrono::seconds(5),
+                 [this] { return frame_ != nullptr || cancelled_; });
+    frame = frame_;
   }
+
+  track_->RemoveRenderer(this);
+  return frame;
 }
 
-bool FlutterFrameCapturer::SaveFrame() {
-  if (frame_ == nullptr) {
+bool FlutterFrameCapturer::EncodeFrame(scoped_refptr<RTCVideoFrame> frame,
+                                       std::vector<uint8_t>* encoded) {
+  int width = frame.get()->width();
+  int height = frame.get()->height();
+  if (width <= 0 || height <= 0) {
     return false;
   }
 
-  int width = frame_.get()->width();
-  int height = frame_.get()->height();
+  // Scale down to fit within the maximum size, which libwebrtc does while
+  // converting the frame.
+  double scale = 1.0;
+  if (options_.max_width > 0 && options_.max_width < width) {
+    scale = static_cast<double>(options_.max_width) / width;
+  }
+  if (options_.max_height > 0 && options_.max_height < height * scale) {
+    scale = static_cast<double>(options_.max_height) / height;
+  }
+  width = std::max(1, static_cast<int>(width * scale));
+  height = std::max(1, static_cast<int>(height * scale));
+
   int bytes_per_pixel = 4;
   std::vector<uint8_t> pixels(width * height * bytes_per_pixel);
+  frame.get()->ConvertToARGB(RTCVideoFrame::Type::kABGR, pixels.data(),
+                             /* unused */ -1, width, height);
 
-  frame_.get()->ConvertToARGB(RTCVideoFrame::Type::kABGR, pixels.data(),
-                              /* unused */ -1, width, height);
-
-  FILE* file = fopen(path_.c_str(), "wb");
-  if (!file) {
-    return false;
+  if (options_.jpeg) {
+    return EncodeJpeg(pixels, width, height, options_.quality, options_.path,
+                      encoded);
   }
-
-  svpng(file, width, height, pixels.data(), 1);
-  fclose(file);
-  return true;
+  return EncodePng(pixels, width, height, options_.path, encoded);
 }
 
-}  // namespace flutter_webrtc_plugin
\ No newline at end of file
+}  // namespace flutter_webrtc_plugin
@@ -3,6 +3,7 @@
 #include "base/scoped_ref_ptr.h"
 #include "flutter_data_channel.h"
 #include "flutter_frame_capturer.h"
+#include "flutter_stats_subscription.h"
 #include "rtc_dtmf_sender.h"
 #include "rtc_rtp_parameters.h"
 
@@ -401,6 +402,8 @@ void FlutterPeerConnection::RTCPeerConnectionClose(
   if (it != base_->peerconnection_observers_.end())
     base_->peerconnection_observers_.erase(it);
 
+  base_->stats_subscriptions_.erase(uuid);
+
   result->Success();
 }
 
@@ -868,10 +871,9 @@ void FlutterPeerConnection::SetConfiguration(
 }
 
 void FlutterPeerConnection::CaptureFrame(
-    RTCVideoTrack* track, std::string path,
+    RTCVideoTrack* track, const FrameCaptureOptions& options,
     std::unique_ptr<MethodResultProxy> result) {
-  FlutterFrameCapturer capturer(track, path);
-  capturer.CaptureFrame(std::move(result));
+  base_->frame_captures_->CaptureFrame(track, options, std::move(result));
 }
 
 scoped_refptr<RTCRtpTransceiver> FlutterPeerConnection::getRtpTransceiverById(
@@ -958,6 +960,27 @@ void FlutterPeerConnection::AddIceCandidate(
   result->Success();
 }
 
+EncodableValue statsMemberToValue(const scoped_refptr<RTCStatsMember>& member) {
+  switch (member->GetType()) {
+    case RTCStatsMember::Type::kBool:
+      return EncodableValue(member->ValueBool());
+    case RTCStatsMember::Type::kInt32:
+      return EncodableValue(member->ValueInt32());
+    case RTCStatsMember::Type::kUint32:
+      return EncodableValue((int64_t)member->ValueUint32());
+    case RTCStatsMember::Type::kInt64:
+      return EncodableValue(member->ValueInt64());
+    case RTCStatsMember::Type::kUint64:
+      return EncodableValue((int64_t)member->ValueUint64());
+    case RTCStatsMember::Type::kDouble:
+      return EncodableValue(member->ValueDouble());
+    case RTCStatsMember::Type::kString:
+      return EncodableValue(member->ValueString().std_string());
+    default:
+      return EncodableValue();
+  }
+}
+
 EncodableMap statsToMap(const scoped_refptr<MediaRTCStats>& stats) {
   EncodableMap report_map;
   report_map[EncodableValue("id")] = EncodableValue(stats->id().std_string());
@@ -969,37 +992,10 @@ EncodableMap statsToMap(const scoped_refptr<MediaRTCStats>& stats) {
   auto members = stats->Members();
   for (int i = 0; i < members.size(); i++) {
     auto member = members[i];
-    switch (member->GetType()) {
-      case RTCStatsMember::Type::kBool:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue(member->ValueBool());
-        break;
-      case RTCStatsMember::Type::kInt32:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue(member->ValueInt32());
-        break;
-      case RTCStatsMember::Type::kUint32:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue((int64_t)member->ValueUint32());
-        break;
-      case RTCStatsMember::Type::kInt64:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue(member->ValueInt64());
-        break;
-      case RTCStatsMember::Type::kUint64:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue((int64_t)member->ValueUint64());
-        break;
-      case RTCStatsMember::Type::kDouble:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue(member->ValueDouble());
-        break;
-      case RTCStatsMember::Type::kString:
-        values[EncodableValue(member->GetName().std_string())] =
-            EncodableValue(member->ValueString().std_string());
-        break;
-      default:
-        break;
+    EncodableValue value = statsMemberToValue(member);
+    if (!value.IsNull()) {
+      values[EncodableValue(member->GetName().std_string())] =
+          std::move(value);
     }
   }
   report_map[EncodableValue("values")] = EncodableValue(values);
@@ -1075,6 +1071,25 @@ void FlutterPeerConnection::GetStats(
   }
 }
 
+void FlutterPeerConnection::SubscribeStats(
+    RTCPeerConnection* pc, const std::string& uuid, uint32_t interval_ms,
+    std::set<std::string> types, std::unique_ptr<MethodResultProxy> result) {
+  std::string event_channel = "FlutterWebRTC/statsEvent" + uuid;
+  // Replaces any previous subscription, so the first event is a full report.
+  base_->stats_subscriptions_.erase(uuid);
+  base_->stats_subscriptions_[uuid] =
+      std::make_shared<FlutterStatsSubscription>(
+          pc, base_->messenger_, base_->task_runner_, event_channel,
+          interval_ms, std::move(types));
+  result->Success();
+}
+
+void FlutterPeerConnection::UnsubscribeStats(
+    const std::string& uuid, std::unique_ptr<MethodResultProxy> result) {
+  base_->stats_subscriptions_.erase(uuid);
+  result->Success();
+}
+
 void FlutterPeerConnection::MediaStreamAddTrack(
     scoped_refptr<RTCMediaStream> stream, scoped_refptr<RTCMediaTrack> track,
     std::unique_ptr<MethodResultProxy> result) {
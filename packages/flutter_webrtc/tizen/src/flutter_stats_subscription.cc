@@ -0,0 +1,167 @@
+#include "flutter_stats_subscription.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+#include "flutter_peerconnection.h"
+#include "task_runner.h"
+
+namespace flutter_webrtc_plugin {
+
+struct FlutterStatsSubscription::State {
+  scoped_refptr<RTCPeerConnection> pc;
+  TaskRunner* task_runner = nullptr;
+  // Owned by the subscription and only used on the main thread, as the
+  // state may be released on the signaling thread.
+  std::weak_ptr<EventChannelProxy> event_channel;
+  std::set<std::string> types;
+  // Whether a sample is being collected, so that a slow collection is not
+  // overlapped by the next one.
+  std::atomic<bool> collecting = false;
+
+  // Guards |last_values|, which is updated on the WebRTC signaling thread.
+  std::mutex mutex;
+  // The member values of each report in the previous sample.
+  std::map<std::string, std::map<std::string, EncodableValue>> last_values;
+
+  void OnStats(const vector<scoped_refptr<MediaRTCStats>>& reports);
+};
+
+void FlutterStatsSubscription::State::OnStats(
+    const vector<scoped_refptr<MediaRTCStats>>& reports) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<std::string, std::map<std::string, EncodableValue>> values;
+  EncodableList changed_reports;
+
+  for (size_t i = 0; i < reports.size(); i++) {
+    scoped_refptr<MediaRTCStats> report = reports[i];
+    std::string type = report->type().std_string();
+    if (!types.empty() && types.find(type) == types.end()) {
+      continue;
+    }
+    std::string id = report->id().std_string();
+    auto last = last_values.find(id);
+    std::map<std::string, EncodableValue>& current = values[id];
+
+    EncodableMap changed_values;
+    auto members = report->Members();
+    for (size_t j = 0; j < members.size(); j++) {
+      EncodableValue value = statsMemberToValue(members[j]);
+      if (value.IsNull()) {
+        continue;
+      }
+      std::string name = members[j]->GetName().std_string();
+      bool changed = true;
+      if (last != last_values.end()) {
+        auto last_value = last->second.find(name);
+        changed = last_value == last->second.end() ||
+                  !(last_value->second == value);
+      }
+      if (changed) {
+        changed_values[EncodableValue(name)] = value;
+      }
+      current[name] = std::move(value);
+    }
+
+    if (last != last_values.end() && changed_values.empty()) {
+      continue;
+    }
+    EncodableMap report_map;
+    report_map[EncodableValue("id")] = EncodableValue(id);
+    report_map[EncodableValue("type")] = EncodableValue(type);
+    report_map[EncodableValue("timestamp")] =
+        EncodableValue(static_cast<double>(report->timestamp_us()));
+    report_map[EncodableValue("values")] =
+        EncodableValue(std::move(changed_values));
+    changed_reports.push_back(EncodableValue(std::move(report_map)));
+  }
+
+  EncodableList removed;
+  for (const auto& [id, last] : last_values) {
+    if (values.find(id) == values.end()) {
+      removed.push_back(EncodableValue(id));
+    }
+  }
+  last_values = std::move(values);
+
+  if (changed_reports.empty() && removed.empty()) {
+    return;
+  }
+  EncodableMap event;
+  event[EncodableValue("event")] = EncodableValue("statsUpdated");
+  event[EncodableValue("reports")] = EncodableValue(std::move(changed_reports));
+  event[EncodableValue("removed")] = EncodableValue(std::move(removed));
+  TaskClosure send = [event_channel = event_channel,
+                      event = EncodableValue(std::move(event))]() mutable {
+    if (auto channel = event_channel.lock()) {
+      channel->Success(std::move(event), false);
+    }
+  };
+  if (task_runner) {
+    task_runner->EnqueueTask(std::move(send));
+  } else {
+    send();
+  }
+}
+
+FlutterStatsSubscription::FlutterStatsSubscription(
+    scoped_refptr<RTCPeerConnection> pc, BinaryMessenger* messenger,
+    TaskRunner* task_runner, const std::string& channel_name,
+    uint32_t interval_ms, std::set<std::string> types)
+    : state_(std::make_shared<State>()),
+      // Events are already posted to the main thread by the state.
+      event_channel_(
+          EventChannelProxy::Create(messenger, nullptr, channel_name)) {
+  state_->pc = pc;
+  state_->task_runner = task_runner;
+  state_->event_channel = event_channel_;
+  state_->types = std::move(types);
+  // Events are not cached before Dart listens, so the first sample after
+  // that is sent in full.
+  event_channel_->SetOnListen([weak_state = std::weak_ptr<State>(state_)]() {
+    if (auto state = weak_state.lock()) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->last_values.clear();
+    }
+  });
+  timer_id_ = g_timeout_add_full(
+      G_PRIORITY_DEFAULT, interval_ms, OnTimeout,
+      new std::weak_ptr<State>(state_),
+      [](gpointer data) { delete static_cast<std::weak_ptr<State>*>(data); });
+}
+
+FlutterStatsSubscription::~FlutterStatsSubscription() {
+  if (timer_id_) {
+    g_source_remove(timer_id_);
+  }
+}
+
+gboolean FlutterStatsSubscription::OnTimeout(gpointer data) {
+  std::shared_ptr<State> state =
+      static_cast<std::weak_ptr<State>*>(data)->lock();
+  if (!state) {
+    return G_SOURCE_REMOVE;
+  }
+  if (state->collecting.exchange(true)) {
+    return G_SOURCE_CONTINUE;
+  }
+  // The callbacks run on the signaling thread and may outlive the
+  // subscription.
+  std::weak_ptr<State> weak_state = state;
+  state->pc->GetStats(
+      [weak_state](const vector<scoped_refptr<MediaRTCStats>> reports) {
+        if (auto state = weak_state.lock()) {
+          state->OnStats(reports);
+          state->collecting = false;
+        }
+      },
+      [weak_state](const char* error) {
+        if (auto state = weak_state.lock()) {
+          state->collecting = false;
+        }
+      });
+  return G_SOURCE_CONTINUE;
+}
+
+}  // namespace flutter_webrtc_plugin
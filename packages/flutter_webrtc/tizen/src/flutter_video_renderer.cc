@@ -1,9 +1,45 @@
 #include "flutter_video_renderer.h"
 
+#include <string.h>
+
+#include "log.h"
+
 namespace flutter_webrtc_plugin {
 
+namespace {
+
+// One surface being written, one waiting for the engine and one being
+// rendered.
+constexpr size_t kBufferPoolSize = 3;
+
+void CopyPlane(const uint8_t* src, int src_stride, uint8_t* dst,
+               int dst_stride, int width, int height) {
+  if (src_stride == width && dst_stride == width) {
+    memcpy(dst, src, size_t(width) * height);
+    return;
+  }
+  for (int row = 0; row < height; row++) {
+    memcpy(dst, src, width);
+    src += src_stride;
+    dst += dst_stride;
+  }
+}
+
+}  // namespace
+
 FlutterVideoRenderer::~FlutterVideoRenderer() {}
 
+bool FlutterVideoRenderer::InitGpuSurface() {
+  if (!BufferPool::IsFormatSupported(TBM_FORMAT_YUV420)) {
+    LOG_INFO("YUV420 tbm surfaces are not supported, using pixel buffers.");
+    return false;
+  }
+  // Surfaces are created at the frame size when they are acquired.
+  buffer_pool_ =
+      std::make_unique<BufferPool>(0, 0, kBufferPoolSize, TBM_FORMAT_YUV420);
+  return true;
+}
+
 void FlutterVideoRenderer::initialize(
     TextureRegistrar* registrar, BinaryMessenger* messenger,
     TaskRunner* task_runner, std::unique_ptr<flutter::TextureVariant> texture,
@@ -19,27 +55,96 @@ void FlutterVideoRenderer::initialize(
 
 const FlutterDesktopPixelBuffer* FlutterVideoRenderer::CopyPixelBuffer(
     size_t width, size_t height) const {
-  mutex_.lock();
-  if (pixel_buffer_.get() && frame_.get()) {
-    if (pixel_buffer_->width != frame_->width() ||
-        pixel_buffer_->height != frame_->height()) {
-      size_t buffer_size =
-          (size_t(frame_->width()) * size_t(frame_->height())) * (32 >> 3);
-      rgb_buffer_.reset(new uint8_t[buffer_size]);
-      pixel_buffer_->width = frame_->width();
-      pixel_buffer_->height = frame_->height();
+  // Take the pending frame under the lock and convert it outside, so that
+  // OnFrame is never blocked by the conversion. The engine uploads the
+  // returned buffer before calling this again, so one buffer is enough.
+  scoped_refptr<RTCVideoFrame> frame;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame = frame_;
+    frame_ = nullptr;
+  }
+  if (!frame.get()) {
+    if (pixel_buffer_.buffer) {
+      frames_reused_++;
+      return &pixel_buffer_;
+    }
+    return nullptr;
+  }
+
+  size_t buffer_size =
+      (size_t(frame->width()) * size_t(frame->height())) * (32 >> 3);
+  if (buffer_size > rgb_buffer_size_) {
+    rgb_buffer_.reset(new uint8_t[buffer_size]);
+    rgb_buffer_size_ = buffer_size;
+  }
+  pixel_buffer_.width = frame->width();
+  pixel_buffer_.height = frame->height();
+
+  frame->ConvertToARGB(RTCVideoFrame::Type::kABGR, rgb_buffer_.get(), 0,
+                       static_cast<int>(pixel_buffer_.width),
+                       static_cast<int>(pixel_buffer_.height));
+
+  pixel_buffer_.buffer = rgb_buffer_.get();
+  frames_converted_++;
+  return &pixel_buffer_;
+}
+
+const FlutterDesktopGpuSurfaceDescriptor*
+FlutterVideoRenderer::ObtainGpuSurface(size_t width, size_t height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (candidate_buffer_) {
+    // The rendered buffer stays in use while it is displayed, and goes back
+    // to the pool when the engine releases its last descriptor.
+    if (rendered_buffer_) {
+      buffer_pool_->Release(rendered_buffer_);
     }
+    rendered_buffer_ = candidate_buffer_;
+    candidate_buffer_ = nullptr;
+  } else if (rendered_buffer_) {
+    frames_reused_++;
+  } else {
+    return nullptr;
+  }
+  return rendered_buffer_->GpuSurface();
+}
+
+bool FlutterVideoRenderer::UploadFrame(
+    const scoped_refptr<RTCVideoFrame>& frame) {
+  int width = frame->width();
+  int height = frame->height();
+  BufferUnit* buffer = buffer_pool_->GetAvailableBuffer(width, height);
+  if (!buffer) {
+    frames_dropped_++;
+    return false;
+  }
 
-    frame_->ConvertToARGB(RTCVideoFrame::Type::kABGR, rgb_buffer_.get(), 0,
-                          static_cast<int>(pixel_buffer_->width),
-                          static_cast<int>(pixel_buffer_->height));
+  tbm_surface_info_s info;
+  if (tbm_surface_map(buffer->Surface(), TBM_SURF_OPTION_WRITE, &info) !=
+      TBM_SURFACE_ERROR_NONE) {
+    LOG_ERROR("Failed to map a tbm surface.");
+    buffer_pool_->Release(buffer);
+    frames_dropped_++;
+    return false;
+  }
+  int chroma_width = (width + 1) / 2;
+  int chroma_height = (height + 1) / 2;
+  CopyPlane(frame->DataY(), frame->StrideY(), info.planes[0].ptr,
+            info.planes[0].stride, width, height);
+  CopyPlane(frame->DataU(), frame->StrideU(), info.planes[1].ptr,
+            info.planes[1].stride, chroma_width, chroma_height);
+  CopyPlane(frame->DataV(), frame->StrideV(), info.planes[2].ptr,
+            info.planes[2].stride, chroma_width, chroma_height);
+  tbm_surface_unmap(buffer->Surface());
 
-    pixel_buffer_->buffer = rgb_buffer_.get();
-    mutex_.unlock();
-    return pixel_buffer_.get();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (candidate_buffer_) {
+    buffer_pool_->Release(candidate_buffer_);
+    frames_dropped_++;
   }
-  mutex_.unlock();
-  return nullptr;
+  candidate_buffer_ = buffer;
+  frames_converted_++;
+  return true;
 }
 
 void FlutterVideoRenderer::OnFrame(scoped_refptr<RTCVideoFrame> frame) {
@@ -48,9 +153,6 @@ void FlutterVideoRenderer::OnFrame(scoped_refptr<RTCVideoFrame> frame) {
     params[EncodableValue("event")] = "didFirstFrameRendered";
     params[EncodableValue("id")] = EncodableValue(texture_id_);
     event_channel_->Success(EncodableValue(params));
-    pixel_buffer_.reset(new FlutterDesktopPixelBuffer());
-    pixel_buffer_->width = 0;
-    pixel_buffer_->height = 0;
     first_frame_rendered = true;
   }
   if (rotation_ != frame->rotation()) {
@@ -73,12 +175,27 @@ void FlutterVideoRenderer::OnFrame(scoped_refptr<RTCVideoFrame> frame) {
 
     last_frame_size_ = {(size_t)frame->width(), (size_t)frame->height()};
   }
-  mutex_.lock();
-  frame_ = frame;
-  mutex_.unlock();
+  if (buffer_pool_) {
+    // The frame is dropped if the engine still holds every surface.
+    if (UploadFrame(frame)) {
+      registrar_->MarkTextureFrameAvailable(texture_id_);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frame_.get()) {
+      frames_dropped_++;
+    }
+    frame_ = frame;
+  }
   registrar_->MarkTextureFrameAvailable(texture_id_);
 }
 
+FlutterVideoRenderer::FrameStats FlutterVideoRenderer::frame_stats() const {
+  return {frames_converted_, frames_dropped_, frames_reused_};
+}
+
 void FlutterVideoRenderer::SetVideoTrack(scoped_refptr<RTCVideoTrack> track) {
   if (track_ != track) {
     if (track_) track_->RemoveRenderer(this);
@@ -110,12 +227,23 @@ FlutterVideoRendererManager::FlutterVideoRendererManager(
 void FlutterVideoRendererManager::CreateVideoRendererTexture(
     std::unique_ptr<MethodResultProxy> result) {
   auto texture = new RefCountedObject<FlutterVideoRenderer>();
-  auto textureVariant =
-      std::make_unique<flutter::TextureVariant>(flutter::PixelBufferTexture(
-          [texture](size_t width,
-                    size_t height) -> const FlutterDesktopPixelBuffer* {
-            return texture->CopyPixelBuffer(width, height);
-          }));
+  std::unique_ptr<flutter::TextureVariant> textureVariant;
+  if (texture->InitGpuSurface()) {
+    textureVariant =
+        std::make_unique<flutter::TextureVariant>(flutter::GpuSurfaceTexture(
+            kFlutterDesktopGpuSurfaceTypeNone,
+            [texture](size_t width, size_t height)
+                -> const FlutterDesktopGpuSurfaceDescriptor* {
+              return texture->ObtainGpuSurface(width, height);
+            }));
+  } else {
+    textureVariant =
+        std::make_unique<flutter::TextureVariant>(flutter::PixelBufferTexture(
+            [texture](size_t width,
+                      size_t height) -> const FlutterDesktopPixelBuffer* {
+              return texture->CopyPixelBuffer(width, height);
+            }));
+  }
 
   auto texture_id = base_->textures_->RegisterTexture(textureVariant.get());
   texture->initialize(base_->textures_, base_->messenger_, base_->task_runner_,
@@ -175,4 +303,23 @@ void FlutterVideoRendererManager::VideoRendererDispose(
                 "VideoRendererDispose() texture not found!");
 }
 
+void FlutterVideoRendererManager::VideoRendererGetFrameStats(
+    int64_t texture_id, std::unique_ptr<MethodResultProxy> result) {
+  auto it = renderers_.find(texture_id);
+  if (it == renderers_.end()) {
+    result->Error("VideoRendererGetFrameStatsFailed",
+                  "VideoRendererGetFrameStats() texture not found!");
+    return;
+  }
+  FlutterVideoRenderer::FrameStats stats = it->second->frame_stats();
+  EncodableMap params;
+  params[EncodableValue("converted")] =
+      EncodableValue(static_cast<int64_t>(stats.converted));
+  params[EncodableValue("dropped")] =
+      EncodableValue(static_cast<int64_t>(stats.dropped));
+  params[EncodableValue("reused")] =
+      EncodableValue(static_cast<int64_t>(stats.reused));
+  result->Success(EncodableValue(params));
+}
+
 }  // namespace flutter_webrtc_plugin
@@ -1,5 +1,7 @@
 #include "flutter_webrtc.h"
 
+#include <algorithm>
+
 #include "flutter_data_channel.h"
 #include "log.h"
 
@@ -314,6 +316,38 @@ void FlutterWebRTC::HandleMethodCall(
       return;
     }
     GetStats(track_id, pc, std::move(result));
+  } else if (method_call.method_name().compare("subscribeStats") == 0) {
+    if (!method_call.arguments()) {
+      result->Error("Bad Arguments", "Null constraints arguments received");
+      return;
+    }
+    const EncodableMap params =
+        GetValue<EncodableMap>(*method_call.arguments());
+    const std::string peerConnectionId = findString(params, "peerConnectionId");
+    RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
+    if (pc == nullptr) {
+      result->Error("subscribeStatsFailed",
+                    "subscribeStats() peerConnection is null");
+      return;
+    }
+    int interval = findInt(params, "interval");
+    std::set<std::string> types;
+    for (const EncodableValue& type : findList(params, "types")) {
+      if (TypeIs<std::string>(type)) {
+        types.insert(GetValue<std::string>(type));
+      }
+    }
+    SubscribeStats(pc, peerConnectionId, interval > 0 ? interval : 1000,
+                   std::move(types), std::move(result));
+  } else if (method_call.method_name().compare("unsubscribeStats") == 0) {
+    if (!method_call.arguments()) {
+      result->Error("Bad Arguments", "Null constraints arguments received");
+      return;
+    }
+    const EncodableMap params =
+        GetValue<EncodableMap>(*method_call.arguments());
+    const std::string peerConnectionId = findString(params, "peerConnectionId");
+    UnsubscribeStats(peerConnectionId, std::move(result));
   } else if (method_call.method_name().compare("createDataChannel") == 0) {
     if (!method_call.arguments()) {
       result->Error("Bad Arguments", "Null constraints arguments received");
@@ -340,8 +374,9 @@ void FlutterWebRTC::HandleMethodCall(
       result->Error("Bad Arguments", "Null constraints arguments received");
       return;
     }
-    const EncodableMap params =
-        GetValue<EncodableMap>(*method_call.arguments());
+    // The arguments are not copied, as the data can be large.
+    const EncodableMap& params =
+        std::get<EncodableMap>(*method_call.arguments());
     const std::string peerConnectionId = findString(params, "peerConnectionId");
     RTCPeerConnection* pc = PeerConnectionForId(peerConnectionId);
     if (pc == nullptr) {
@@ -352,14 +387,16 @@ void FlutterWebRTC::HandleMethodCall(
 
     const std::string dataChannelId = findString(params, "dataChannelId");
     const std::string type = findString(params, "type");
-    const EncodableValue data = findEncodableValue(params, "data");
+    auto data = params.find(EncodableValue("data"));
     RTCDataChannel* data_channel = DataChannelForId(dataChannelId);
     if (data_channel == nullptr) {
       result->Error("dataChannelSendFailed",
                     "dataChannelSend() data_channel is null");
       return;
     }
-    DataChannelSend(data_channel, type, data, std::move(result));
+    DataChannelSend(data_channel, type,
+                    data != params.end() ? data->second : EncodableValue(),
+                    std::move(result));
   } else if (method_call.method_name().compare(
                  "dataChannelGetBufferedAmount") == 0) {
     if (!method_call.arguments()) {
@@ -495,6 +532,16 @@ void FlutterWebRTC::HandleMethodCall(
         GetValue<EncodableMap>(*method_call.arguments());
     int64_t texture_id = findLongInt(params, "textureId");
     VideoRendererDispose(texture_id, std::move(result));
+  } else if (method_call.method_name().compare(
+                 "videoRendererGetFrameStats") == 0) {
+    if (!method_call.arguments()) {
+      result->Error("Bad Arguments", "Null constraints arguments received");
+      return;
+    }
+    const EncodableMap params =
+        GetValue<EncodableMap>(*method_call.arguments());
+    int64_t texture_id = findLongInt(params, "textureId");
+    VideoRendererGetFrameStats(texture_id, std::move(result));
   } else if (method_call.method_name().compare("videoRendererSetSrcObject") ==
              0) {
     if (!method_call.arguments()) {
@@ -1013,11 +1060,24 @@ void FlutterWebRTC::HandleMethodCall(
     const EncodableMap params =
         GetValue<EncodableMap>(*method_call.arguments());
 
-    const std::string path = findString(params, "path");
-    if (path.empty()) {
-      result->Error("captureFrame", "captureFrame() path is null or empty");
-      return;
+    // Without a path, the encoded frame is returned instead of saved.
+    FrameCaptureOptions options;
+    options.path = findString(params, "path");
+    std::string format = findString(params, "format");
+    if (format.empty()) {
+      size_t dot = options.path.rfind('.');
+      if (dot != std::string::npos) {
+        format = options.path.substr(dot + 1);
+      }
+    }
+    std::transform(format.begin(), format.end(), format.begin(), ::tolower);
+    options.jpeg = format == "jpg" || format == "jpeg";
+    int quality = findInt(params, "quality");
+    if (quality > 0) {
+      options.quality = quality;
     }
+    options.max_width = std::max(findInt(params, "maxWidth"), 0);
+    options.max_height = std::max(findInt(params, "maxHeight"), 0);
 
     const std::string trackId = findString(params, "trackId");
     scoped_refptr<RTCMediaTrack> track = MediaTrackForId(trackId);
@@ -1030,7 +1090,7 @@ void FlutterWebRTC::HandleMethodCall(
       result->Error("captureFrame", "captureFrame() track not is video track");
       return;
     }
-    CaptureFrame(reinterpret_cast<RTCVideoTrack*>(track.get()), path,
+    CaptureFrame(reinterpret_cast<RTCVideoTrack*>(track.get()), options,
                  std::move(result));
 
   } else if (method_call.method_name().compare("createLocalMediaStream") == 0) {
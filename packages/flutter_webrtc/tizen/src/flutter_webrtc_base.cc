@@ -1,6 +1,7 @@
 #include "flutter_webrtc_base.h"
 
 #include "flutter_data_channel.h"
+#include "flutter_frame_capturer.h"
 #include "flutter_peerconnection.h"
 #include "helper.h"
 
@@ -11,7 +12,10 @@ const char* kEventChannelName = "FlutterWebRTC.Event";
 FlutterWebRTCBase::FlutterWebRTCBase(BinaryMessenger* messenger,
                                      TextureRegistrar* textures,
                                      TaskRunner* task_runner)
-    : messenger_(messenger), task_runner_(task_runner), textures_(textures) {
+    : messenger_(messenger),
+      task_runner_(task_runner),
+      textures_(textures),
+      frame_captures_(std::make_unique<FrameCaptureGroup>()) {
   LibWebRTC::Initialize();
   factory_ = LibWebRTC::CreateRTCPeerConnectionFactory();
   factory_->Initialize();
@@ -22,7 +26,11 @@ FlutterWebRTCBase::FlutterWebRTCBase(BinaryMessenger* messenger,
       EventChannelProxy::Create(messenger_, task_runner_, kEventChannelName);
 }
 
-FlutterWebRTCBase::~FlutterWebRTCBase() { LibWebRTC::Terminate(); }
+FlutterWebRTCBase::~FlutterWebRTCBase() {
+  // The captures use their tracks until they are joined.
+  frame_captures_.reset();
+  LibWebRTC::Terminate();
+}
 
 EventChannelProxy* FlutterWebRTCBase::event_channel() {
   return event_channel_ ? event_channel_.get() : nullptr;
@@ -54,6 +54,27 @@ class FlutterWebRtcTizenPlugin : public FlutterWebRTCPlugin {
   // Called when a method is called on |channel_|;
   void HandleMethodCall(const MethodCall& method_call,
                         std::unique_ptr<MethodResult> result) {
+    if (method_call.method_name() == "getTaskRunnerStats") {
+      TaskRunnerStats stats = task_runner_->GetStats();
+      EncodableMap map;
+      map[EncodableValue("queueDepth")] =
+          EncodableValue(static_cast<int64_t>(stats.queue_depth));
+      map[EncodableValue("maxQueueDepth")] =
+          EncodableValue(static_cast<int64_t>(stats.max_queue_depth));
+      map[EncodableValue("enqueued")] =
+          EncodableValue(static_cast<int64_t>(stats.enqueued));
+      map[EncodableValue("run")] =
+          EncodableValue(static_cast<int64_t>(stats.run));
+      map[EncodableValue("wakeups")] =
+          EncodableValue(static_cast<int64_t>(stats.wakeups));
+      map[EncodableValue("averageLatencyUs")] =
+          EncodableValue(stats.average_latency_us);
+      map[EncodableValue("maxLatencyUs")] =
+          EncodableValue(stats.max_latency_us);
+      result->Success(EncodableValue(map));
+      return;
+    }
+
     // handle method call and forward to webrtc native sdk.
     auto method_call_proxy = MethodCallProxy::Create(method_call);
     webrtc_->HandleMethodCall(*method_call_proxy.get(),
@@ -65,7 +86,7 @@ class FlutterWebRtcTizenPlugin : public FlutterWebRTCPlugin {
   std::unique_ptr<FlutterWebRTC> webrtc_;
   BinaryMessenger* messenger_;
   TextureRegistrar* textures_;
-  std::unique_ptr<TaskRunner> task_runner_;
+  std::unique_ptr<TaskRunnerTizen> task_runner_;
 };
 
 }  // namespace flutter_webrtc_plugin
@@ -4,23 +4,124 @@
 
 #include "task_runner_tizen.h"
 
-TaskRunnerTizen::TaskRunnerTizen() = default;
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
 
-TaskRunnerTizen::~TaskRunnerTizen() = default;
+#include "log.h"
+
+namespace {
+
+// Tasks that wait longer than this are logged, as they delay signaling
+// and stats events.
+constexpr int64_t kStallThresholdUs = 100 * 1000;
+
+int64_t NowMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct PendingTask {
+  TaskClosure task;
+  int64_t enqueued_us;
+};
+
+}  // namespace
+
+struct TaskRunnerTizen::TaskQueue {
+  std::mutex mutex;
+  std::vector<PendingTask> tasks;
+  // Whether a main loop source is pending to run |tasks|.
+  bool scheduled = false;
+  bool closed = false;
+
+  size_t max_queue_depth = 0;
+  uint64_t enqueued = 0;
+  uint64_t run = 0;
+  uint64_t wakeups = 0;
+  int64_t total_latency_us = 0;
+  int64_t max_latency_us = 0;
+};
+
+TaskRunnerTizen::TaskRunnerTizen() : queue_(std::make_shared<TaskQueue>()) {}
+
+TaskRunnerTizen::~TaskRunnerTizen() {
+  // The dropped tasks are destroyed after the lock is released.
+  std::vector<PendingTask> tasks;
+  {
+    std::lock_guard<std::mutex> lock(queue_->mutex);
+    queue_->closed = true;
+    tasks.swap(queue_->tasks);
+  }
+}
 
 void TaskRunnerTizen::EnqueueTask(TaskClosure task) {
-  std::lock_guard<std::mutex> lock(tasks_mutex_);
-  tasks_.push(std::move(task));
-  g_idle_add_full(G_PRIORITY_DEFAULT, RunTask, this, nullptr);
+  int64_t now = NowMicroseconds();
+  std::lock_guard<std::mutex> lock(queue_->mutex);
+  if (queue_->closed) {
+    return;
+  }
+  queue_->tasks.push_back({std::move(task), now});
+  queue_->enqueued++;
+  queue_->max_queue_depth =
+      std::max(queue_->max_queue_depth, queue_->tasks.size());
+  if (!queue_->scheduled) {
+    queue_->scheduled = true;
+    g_idle_add_full(G_PRIORITY_DEFAULT, RunTasks,
+                    new std::shared_ptr<TaskQueue>(queue_), [](gpointer data) {
+                      delete static_cast<std::shared_ptr<TaskQueue>*>(data);
+                    });
+  }
+}
+
+TaskRunnerStats TaskRunnerTizen::GetStats() const {
+  std::lock_guard<std::mutex> lock(queue_->mutex);
+  TaskRunnerStats stats;
+  stats.queue_depth = queue_->tasks.size();
+  stats.max_queue_depth = queue_->max_queue_depth;
+  stats.enqueued = queue_->enqueued;
+  stats.run = queue_->run;
+  stats.wakeups = queue_->wakeups;
+  if (queue_->run > 0) {
+    stats.average_latency_us =
+        queue_->total_latency_us / static_cast<int64_t>(queue_->run);
+  }
+  stats.max_latency_us = queue_->max_latency_us;
+  return stats;
 }
 
-gboolean TaskRunnerTizen::RunTask(gpointer data) {
-  TaskRunnerTizen* runner = static_cast<TaskRunnerTizen*>(data);
-  std::lock_guard<std::mutex> lock(runner->tasks_mutex_);
-  while (!runner->tasks_.empty()) {
-    TaskClosure task = std::move(runner->tasks_.front());
-    runner->tasks_.pop();
-    task();
+gboolean TaskRunnerTizen::RunTasks(gpointer data) {
+  TaskQueue* queue = static_cast<std::shared_ptr<TaskQueue>*>(data)->get();
+  std::vector<PendingTask> tasks;
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    // Tasks enqueued from now on schedule the next wakeup.
+    queue->scheduled = false;
+    if (queue->closed) {
+      return G_SOURCE_REMOVE;
+    }
+    tasks.swap(queue->tasks);
+  }
+
+  int64_t total_latency_us = 0;
+  int64_t max_latency_us = 0;
+  for (PendingTask& pending : tasks) {
+    int64_t latency = NowMicroseconds() - pending.enqueued_us;
+    total_latency_us += latency;
+    max_latency_us = std::max(max_latency_us, latency);
+    pending.task();
   }
+  if (max_latency_us > kStallThresholdUs) {
+    LOG_WARN("%zu tasks waited up to %lld ms to run.", tasks.size(),
+             static_cast<long long>(max_latency_us / 1000));
+  }
+
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->run += tasks.size();
+  queue->wakeups++;
+  queue->total_latency_us += total_latency_us;
+  queue->max_latency_us = std::max(queue->max_latency_us, max_latency_us);
   return G_SOURCE_REMOVE;
 }
@@ -13,9 +13,11 @@
 #include <memory>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "image_resize.h"
 #include "permission_manager.h"
+#include "resize_worker_pool.h"
 
 namespace {
 
@@ -220,35 +222,43 @@ class ImagePickerTizenPlugin : public flutter::Plugin {
       return;
     }
 
-    if (count == 0) {
-      self->SendErrorResult("Operation cancelled", "No file selected.");
-    } else if (self->multi_image_) {
-      flutter::EncodableList paths;
-      for (int i = 0; i < count; i++) {
-        std::string source_path = values[i];
-        std::string dest_path;
-        if (self->image_resize_.Resize(source_path, &dest_path)) {
-          paths.push_back(flutter::EncodableValue(dest_path));
-        } else {
-          paths.push_back(flutter::EncodableValue(source_path));
-        }
-        free(values[i]);
-      }
-      self->SendResult(flutter::EncodableValue(paths));
-    } else {
-      std::string source_path = values[0];
-      std::string dest_path;
-      if (self->image_resize_.Resize(source_path, &dest_path)) {
-        self->SendResult(flutter::EncodableValue(dest_path));
-      } else {
-        self->SendResult(flutter::EncodableValue(source_path));
-      }
-      free(values[0]);
+    std::vector<std::string> source_paths;
+    for (int i = 0; i < count; i++) {
+      source_paths.push_back(values[i]);
+      free(values[i]);
     }
-
     if (values) {
       free(values);
     }
+
+    if (source_paths.empty()) {
+      self->SendErrorResult("Operation cancelled", "No file selected.");
+      return;
+    }
+    if (!self->multi_image_) {
+      source_paths.resize(1);
+    }
+
+    // Resizing large photos takes a while, so it is done on worker threads.
+    // |result_| stays set until the paths are sent, so no other pick can
+    // start in the meantime.
+    std::weak_ptr<bool> is_alive = self->is_alive_;
+    ResizeWorkerPool::Run(
+        self->image_resize_, std::move(source_paths),
+        [self, is_alive](const std::vector<std::string> &paths) {
+          if (is_alive.expired()) {
+            return;
+          }
+          if (!self->multi_image_) {
+            self->SendResult(flutter::EncodableValue(paths[0]));
+            return;
+          }
+          flutter::EncodableList list;
+          for (const std::string &path : paths) {
+            list.push_back(flutter::EncodableValue(path));
+          }
+          self->SendResult(flutter::EncodableValue(list));
+        });
   }
 
   void SendResult(const flutter::EncodableValue &result) {
@@ -271,6 +281,7 @@ class ImagePickerTizenPlugin : public flutter::Plugin {
   std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result_;
   ImageResize image_resize_;
   bool multi_image_ = false;
+  std::shared_ptr<bool> is_alive_ = std::make_shared<bool>(true);
 };
 
 }  // namespace
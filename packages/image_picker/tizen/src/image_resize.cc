@@ -8,63 +8,205 @@
 #include <app_common.h>
 
 #include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 #include "log.h"
 
-bool ImageResize::DecodeImage(const std::string& path,
-                              image_util_image_h* image) {
-  image_util_decode_h handle = nullptr;
-  int ret = image_util_decode_create(&handle);
-  if (ret != IMAGE_UTIL_ERROR_NONE) {
-    LOG_ERROR("Failed to initialize image decode util: %s",
-              get_error_message(ret));
-    return false;
+namespace {
+
+// The decoded size of a 12 MP photo, assumed for images whose size cannot be
+// read without decoding them.
+constexpr size_t kUnknownImageBytes = 4000 * 3000 * 4;
+
+// The EXIF orientation tag and the values it takes, which tell how the
+// stored image is transformed relative to how it should be displayed.
+constexpr uint16_t kExifOrientationTag = 0x0112;
+enum Orientation {
+  kOrientationNormal = 1,
+  kOrientationFlipHorizontal = 2,
+  kOrientationRotate180 = 3,
+  kOrientationFlipVertical = 4,
+  kOrientationTranspose = 5,
+  kOrientationRotate90 = 6,
+  kOrientationTransverse = 7,
+  kOrientationRotate270 = 8,
+};
+
+struct JpegInfo {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  int orientation = kOrientationNormal;
+};
+
+// Returns the orientation stored in the EXIF data of an APP1 segment, or
+// kOrientationNormal if there is none.
+int ParseExifOrientation(const std::vector<uint8_t>& segment) {
+  constexpr uint8_t kExifHeader[] = {'E', 'x', 'i', 'f', 0, 0};
+  constexpr size_t kTiffStart = sizeof(kExifHeader);
+  if (segment.size() < kTiffStart + 8 ||
+      !std::equal(std::begin(kExifHeader), std::end(kExifHeader),
+                  segment.begin())) {
+    return kOrientationNormal;
   }
+  const uint8_t* tiff = segment.data() + kTiffStart;
+  size_t size = segment.size() - kTiffStart;
+  bool little_endian = tiff[0] == 'I' && tiff[1] == 'I';
+  if (!little_endian && !(tiff[0] == 'M' && tiff[1] == 'M')) {
+    return kOrientationNormal;
+  }
+  auto read16 = [&](size_t offset) -> uint16_t {
+    return little_endian ? tiff[offset] | tiff[offset + 1] << 8
+                         : tiff[offset] << 8 | tiff[offset + 1];
+  };
+  auto read32 = [&](size_t offset) -> uint32_t {
+    uint32_t first = read16(offset);
+    uint32_t second = read16(offset + 2);
+    return little_endian ? first | second << 16 : first << 16 | second;
+  };
 
-  ret = image_util_decode_set_input_path(handle, path.c_str());
-  if (ret != IMAGE_UTIL_ERROR_NONE) {
-    LOG_ERROR("Failed to set image path: %s", get_error_message(ret));
-    image_util_decode_destroy(handle);
-    return false;
+  size_t ifd = read32(4);
+  if (ifd > size - 2) {
+    return kOrientationNormal;
+  }
+  uint16_t count = read16(ifd);
+  for (uint16_t i = 0; i < count; i++) {
+    size_t entry = ifd + 2 + i * 12;
+    if (entry + 12 > size) {
+      break;
+    }
+    if (read16(entry) == kExifOrientationTag) {
+      // A SHORT value is stored in the first two bytes of the value field.
+      uint16_t orientation = read16(entry + 8);
+      if (orientation >= kOrientationNormal &&
+          orientation <= kOrientationRotate270) {
+        return orientation;
+      }
+      break;
+    }
   }
+  return kOrientationNormal;
+}
 
-  ret = image_util_decode_run2(handle, image);
-  if (ret != IMAGE_UTIL_ERROR_NONE) {
-    LOG_ERROR("Failed to decode image: %s", get_error_message(ret));
-    image_util_decode_destroy(handle);
+// Reads the size and the EXIF orientation of a JPEG image from its headers
+// without decoding it. The size is that of the stored image, before the
+// orientation is applied.
+bool ReadJpegInfo(const std::string& path, JpegInfo* info) {
+  std::ifstream file(path, std::ios::binary);
+  if (file.get() != 0xFF || file.get() != 0xD8) {
     return false;
   }
+  while (file) {
+    int marker = file.get();
+    if (marker != 0xFF) {
+      return false;
+    }
+    while (marker == 0xFF) {
+      marker = file.get();
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+      // Markers without a segment.
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA || marker == EOF) {
+      // The image data starts before a frame header is found.
+      return false;
+    }
+    int length = file.get() << 8;
+    length |= file.get();
+    if (!file || length < 2) {
+      return false;
+    }
+    // SOF0 to SOF15, except DHT (0xC4), JPG (0xC8) and DAC (0xCC).
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+        marker != 0xC8 && marker != 0xCC) {
+      uint8_t header[5];
+      if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+      }
+      info->height = header[1] << 8 | header[2];
+      info->width = header[3] << 8 | header[4];
+      return info->width > 0 && info->height > 0;
+    }
+    if (marker == 0xE1) {
+      // APP1, which holds the EXIF data and comes before the frame header.
+      std::vector<uint8_t> segment(length - 2);
+      if (!file.read(reinterpret_cast<char*>(segment.data()),
+                     segment.size())) {
+        return false;
+      }
+      if (info->orientation == kOrientationNormal) {
+        info->orientation = ParseExifOrientation(segment);
+      }
+      continue;
+    }
+    file.seekg(length - 2, std::ios::cur);
+  }
+  return false;
+}
 
-  image_util_decode_destroy(handle);
-  return true;
+// Whether the orientation swaps the width and the height of the image.
+bool IsTransposed(int orientation) {
+  return orientation >= kOrientationTranspose;
 }
 
-bool ImageResize::TransformImage(image_util_image_h input,
-                                 image_util_image_h* output) {
-  transformation_h handle = nullptr;
-  int ret = image_util_transform_create(&handle);
-  if (ret != IMAGE_UTIL_ERROR_NONE) {
-    LOG_ERROR("Failed to initialize image transform util: %s",
-              get_error_message(ret));
-    return false;
+// Returns the rotations that turn the stored image upright. Transpose and
+// transverse need a flip after the rotation, which image_util cannot do in
+// the same pass.
+std::pair<image_util_rotation_e, image_util_rotation_e> GetRotations(
+    int orientation) {
+  switch (orientation) {
+    case kOrientationFlipHorizontal:
+      return {IMAGE_UTIL_ROTATION_FLIP_HORZ, IMAGE_UTIL_ROTATION_NONE};
+    case kOrientationRotate180:
+      return {IMAGE_UTIL_ROTATION_180, IMAGE_UTIL_ROTATION_NONE};
+    case kOrientationFlipVertical:
+      return {IMAGE_UTIL_ROTATION_FLIP_VERT, IMAGE_UTIL_ROTATION_NONE};
+    case kOrientationTranspose:
+      return {IMAGE_UTIL_ROTATION_90, IMAGE_UTIL_ROTATION_FLIP_HORZ};
+    case kOrientationRotate90:
+      return {IMAGE_UTIL_ROTATION_90, IMAGE_UTIL_ROTATION_NONE};
+    case kOrientationTransverse:
+      return {IMAGE_UTIL_ROTATION_90, IMAGE_UTIL_ROTATION_FLIP_VERT};
+    case kOrientationRotate270:
+      return {IMAGE_UTIL_ROTATION_270, IMAGE_UTIL_ROTATION_NONE};
+    default:
+      return {IMAGE_UTIL_ROTATION_NONE, IMAGE_UTIL_ROTATION_NONE};
   }
+}
 
-  uint32_t original_width;
-  uint32_t original_height;
-  ret = image_util_get_image(input, &original_width, &original_height, nullptr,
-                             nullptr, nullptr);
-  if (ret != IMAGE_UTIL_ERROR_NONE) {
-    LOG_ERROR("Failed to get image size: %s", get_error_message(ret));
-    image_util_transform_destroy(handle);
-    return false;
+// Returns the largest JPEG downscale that keeps the decoded image at least
+// as large as the target size, so that the final resample only shrinks it.
+image_util_scale_e ChooseDownscale(uint32_t original_width,
+                                   uint32_t original_height, uint32_t width,
+                                   uint32_t height) {
+  const std::pair<uint32_t, image_util_scale_e> kDownscales[] = {
+      {8, IMAGE_UTIL_DOWNSCALE_1_8},
+      {4, IMAGE_UTIL_DOWNSCALE_1_4},
+      {2, IMAGE_UTIL_DOWNSCALE_1_2},
+  };
+  for (const auto& [factor, downscale] : kDownscales) {
+    if (original_width / factor >= width &&
+        original_height / factor >= height) {
+      return downscale;
+    }
   }
+  return IMAGE_UTIL_DOWNSCALE_1_1;
+}
 
+}  // namespace
+
+void ImageResize::GetTargetSize(uint32_t original_width,
+                                uint32_t original_height, uint32_t* width,
+                                uint32_t* height) {
   bool has_max_width = max_width_ != 0;
   bool has_max_height = max_height_ != 0;
 
-  uint32_t width =
+  *width =
       has_max_width ? std::min(original_width, max_width_) : original_width;
-  uint32_t height =
+  *height =
       has_max_height ? std::min(original_height, max_height_) : original_height;
 
   bool should_downscale_width = has_max_width && max_width_ < original_width;
@@ -73,39 +215,141 @@ bool ImageResize::TransformImage(image_util_image_h input,
 
   if (should_downscale_width || should_downscale_height) {
     uint32_t downscaled_width =
-        (height / static_cast<float>(original_height)) * original_width;
+        (*height / static_cast<float>(original_height)) * original_width;
     uint32_t downscaled_height =
-        (width / static_cast<float>(original_width)) * original_height;
+        (*width / static_cast<float>(original_width)) * original_height;
 
-    if (width < height) {
+    if (*width < *height) {
       if (!has_max_width) {
-        width = downscaled_width;
+        *width = downscaled_width;
       } else {
-        height = downscaled_height;
+        *height = downscaled_height;
       }
-    } else if (height < width) {
+    } else if (*height < *width) {
       if (!has_max_height) {
-        height = downscaled_height;
+        *height = downscaled_height;
       } else {
-        width = downscaled_width;
+        *width = downscaled_width;
       }
     } else {
       if (original_width < original_height) {
-        width = downscaled_width;
+        *width = downscaled_width;
       } else if (original_height < original_width) {
-        height = downscaled_height;
+        *height = downscaled_height;
       }
     }
   }
+}
+
+void ImageResize::GetScaledSize(uint32_t original_width,
+                                uint32_t original_height, bool transposed,
+                                uint32_t* width, uint32_t* height) {
+  if (transposed) {
+    GetTargetSize(original_height, original_width, height, width);
+  } else {
+    GetTargetSize(original_width, original_height, width, height);
+  }
+}
+
+size_t ImageResize::EstimateMemory(const std::string& path) {
+  JpegInfo info;
+  if (!ReadJpegInfo(path, &info)) {
+    return kUnknownImageBytes;
+  }
+  uint32_t width = 0;
+  uint32_t height = 0;
+  GetScaledSize(info.width, info.height, IsTransposed(info.orientation),
+                &width, &height);
+  uint32_t factor = 1;
+  switch (ChooseDownscale(info.width, info.height, width, height)) {
+    case IMAGE_UTIL_DOWNSCALE_1_8:
+      factor = 8;
+      break;
+    case IMAGE_UTIL_DOWNSCALE_1_4:
+      factor = 4;
+      break;
+    case IMAGE_UTIL_DOWNSCALE_1_2:
+      factor = 2;
+      break;
+    default:
+      break;
+  }
+  // Both the decoded and the transformed image are in RGBA.
+  size_t decoded_pixels =
+      static_cast<size_t>(info.width / factor) * (info.height / factor);
+  size_t target_pixels = static_cast<size_t>(width) * height;
+  return (decoded_pixels + target_pixels) * 4;
+}
+
+bool ImageResize::DecodeImage(const std::string& path,
+                              image_util_scale_e downscale,
+                              image_util_image_h* image) {
+  image_util_decode_h handle = nullptr;
+  int ret = image_util_decode_create(&handle);
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("Failed to initialize image decode util: %s",
+              get_error_message(ret));
+    return false;
+  }
+
+  ret = image_util_decode_set_input_path(handle, path.c_str());
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("Failed to set image path: %s", get_error_message(ret));
+    image_util_decode_destroy(handle);
+    return false;
+  }
+
+  if (downscale != IMAGE_UTIL_DOWNSCALE_1_1) {
+    ret = image_util_decode_set_jpeg_downscale(handle, downscale);
+    if (ret != IMAGE_UTIL_ERROR_NONE) {
+      // Not fatal, the image is then scaled by the transform only.
+      LOG_ERROR("Failed to set JPEG downscale: %s", get_error_message(ret));
+    }
+  }
 
-  LOG_DEBUG("Target image resolution: %d x %d", width, height);
-  ret = image_util_transform_set_resolution(handle, width, height);
+  ret = image_util_decode_run2(handle, image);
   if (ret != IMAGE_UTIL_ERROR_NONE) {
-    LOG_ERROR("Failed to set image resolution: %s", get_error_message(ret));
-    image_util_transform_destroy(handle);
+    LOG_ERROR("Failed to decode image: %s", get_error_message(ret));
+    image_util_decode_destroy(handle);
+    return false;
+  }
+
+  image_util_decode_destroy(handle);
+  return true;
+}
+
+bool ImageResize::TransformImage(image_util_image_h input, uint32_t width,
+                                 uint32_t height,
+                                 image_util_rotation_e rotation,
+                                 image_util_image_h* output) {
+  transformation_h handle = nullptr;
+  int ret = image_util_transform_create(&handle);
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("Failed to initialize image transform util: %s",
+              get_error_message(ret));
     return false;
   }
 
+  if (width > 0 && height > 0) {
+    LOG_DEBUG("Target image resolution: %d x %d", width, height);
+    ret = image_util_transform_set_resolution(handle, width, height);
+    if (ret != IMAGE_UTIL_ERROR_NONE) {
+      LOG_ERROR("Failed to set image resolution: %s", get_error_message(ret));
+      image_util_transform_destroy(handle);
+      return false;
+    }
+  }
+
+  if (rotation != IMAGE_UTIL_ROTATION_NONE) {
+    LOG_DEBUG("Target image rotation: %d", rotation);
+    ret = image_util_transform_set_rotation(handle, rotation);
+    if (ret != IMAGE_UTIL_ERROR_NONE) {
+      LOG_ERROR("Failed to set image rotation: %s", get_error_message(ret));
+      image_util_transform_destroy(handle);
+      return false;
+    }
+  }
+
   ret = image_util_transform_run2(handle, input, output);
   if (ret != IMAGE_UTIL_ERROR_NONE) {
     LOG_ERROR("Failed to transform image: %s", get_error_message(ret));
@@ -171,24 +415,67 @@ bool ImageResize::EncodeImage(image_util_image_h image,
   return true;
 }
 
-bool ImageResize::Resize(const std::string& source_path,
+bool ImageResize::Resize(const std::string& source_path, size_t index,
                          std::string* dest_path) {
   bool should_scale = max_width_ != 0 || max_height_ != 0 || IsValidQuality();
   if (!should_scale) {
     return false;
   }
 
-  image_util_image_h source_image = nullptr;
-  if (!DecodeImage(source_path, &source_image)) {
-    return false;
+  // For JPEG images, the target size is known before decoding, so the
+  // decoder can skip most of the work for large photos. The image is scaled
+  // as stored and then turned upright in the same transform, so that the
+  // caller does not have to apply the EXIF orientation afterwards. The
+  // orientation tag is not written to the output.
+  JpegInfo info;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  image_util_scale_e downscale = IMAGE_UTIL_DOWNSCALE_1_1;
+  bool has_size = ReadJpegInfo(source_path, &info);
+  if (has_size) {
+    GetScaledSize(info.width, info.height, IsTransposed(info.orientation),
+                  &width, &height);
+    downscale = ChooseDownscale(info.width, info.height, width, height);
   }
+  auto [rotation, flip] = GetRotations(info.orientation);
 
   image_util_image_h image = nullptr;
-  if (!TransformImage(source_image, &image)) {
-    image_util_destroy_image(source_image);
+  if (!DecodeImage(source_path, downscale, &image)) {
+    return false;
+  }
+
+  uint32_t decoded_width = 0;
+  uint32_t decoded_height = 0;
+  int ret = image_util_get_image(image, &decoded_width, &decoded_height,
+                                 nullptr, nullptr, nullptr);
+  if (ret != IMAGE_UTIL_ERROR_NONE) {
+    LOG_ERROR("Failed to get image size: %s", get_error_message(ret));
+    image_util_destroy_image(image);
     return false;
   }
-  image_util_destroy_image(source_image);
+  if (!has_size) {
+    GetTargetSize(decoded_width, decoded_height, &width, &height);
+  }
+
+  if (decoded_width == width && decoded_height == height) {
+    // Already at the target size, so only rotate the image if needed.
+    width = 0;
+    height = 0;
+  }
+  for (image_util_rotation_e step : {rotation, flip}) {
+    if (step == IMAGE_UTIL_ROTATION_NONE && (width == 0 || height == 0)) {
+      continue;
+    }
+    image_util_image_h transformed_image = nullptr;
+    if (!TransformImage(image, width, height, step, &transformed_image)) {
+      image_util_destroy_image(image);
+      return false;
+    }
+    image_util_destroy_image(image);
+    image = transformed_image;
+    width = 0;
+    height = 0;
+  }
 
   char* base_dir = app_get_cache_path();
   *dest_path = std::string(base_dir);
@@ -196,7 +483,8 @@ bool ImageResize::Resize(const std::string& source_path,
 
   size_t pos = source_path.rfind("/");
   if (pos != std::string::npos) {
-    *dest_path += "scaled_" + source_path.substr(pos + 1);
+    *dest_path += "scaled_" + std::to_string(index) + "_" +
+                  source_path.substr(pos + 1);
   } else {
     image_util_destroy_image(image);
     return false;
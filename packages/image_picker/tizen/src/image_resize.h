@@ -20,14 +20,39 @@ class ImageResize {
     quality_ = quality;
   }
 
-  bool Resize(const std::string& input_path, std::string* output_path);
+  // Writes the resized image to the cache directory. |index| is part of the
+  // output file name, so that images with the same name do not overwrite
+  // each other.
+  bool Resize(const std::string& input_path, size_t index,
+              std::string* output_path);
+
+  // Returns an estimate of the memory in bytes that resizing the image at
+  // |path| needs for its decoded and transformed pixels.
+  size_t EstimateMemory(const std::string& path);
 
  private:
   bool IsValidQuality() { return quality_ > 0 && quality_ < 100; }
 
-  bool DecodeImage(const std::string& path, image_util_image_h* image);
+  // Computes the output size of an image of the given size so that it fits
+  // within |max_width_| and |max_height_| with the same aspect ratio.
+  void GetTargetSize(uint32_t original_width, uint32_t original_height,
+                     uint32_t* width, uint32_t* height);
+
+  // Same as GetTargetSize, but returns the size of the image as stored if
+  // it is |transposed| when displayed.
+  void GetScaledSize(uint32_t original_width, uint32_t original_height,
+                     bool transposed, uint32_t* width, uint32_t* height);
+
+  // JPEG images are decoded at |downscale| of their size, which the decoder
+  // does in the DCT domain without decoding the full-size image.
+  bool DecodeImage(const std::string& path, image_util_scale_e downscale,
+                   image_util_image_h* image);
 
-  bool TransformImage(image_util_image_h input, image_util_image_h* output);
+  // Scales |input| to |width| x |height| unless they are zero, and then
+  // applies |rotation|.
+  bool TransformImage(image_util_image_h input, uint32_t width,
+                      uint32_t height, image_util_rotation_e rotation,
+                      image_util_image_h* output);
 
   bool EncodeImage(image_util_image_h image, const std::string& path);
 
@@ -0,0 +1,107 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "resize_worker_pool.h"
+
+#include <glib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "log.h"
+
+namespace {
+
+// The total memory that images being resized at the same time may use.
+constexpr size_t kMemoryBudget = 256 * 1024 * 1024;
+
+class MemoryBudget {
+ public:
+  explicit MemoryBudget(size_t budget) : budget_(budget) {}
+
+  // Waits until |bytes| fit in the budget. An image that exceeds the budget
+  // by itself is let through once nothing else is in flight.
+  void Acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this, bytes] {
+      return in_use_ == 0 || in_use_ + bytes <= budget_;
+    });
+    in_use_ += bytes;
+  }
+
+  void Release(size_t bytes) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      in_use_ -= bytes;
+    }
+    condition_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t budget_;
+  size_t in_use_ = 0;
+};
+
+struct CompletedData {
+  ResizeCompletedCallback on_completed;
+  std::vector<std::string> paths;
+};
+
+}  // namespace
+
+void ResizeWorkerPool::Run(const ImageResize& resize,
+                           std::vector<std::string> paths,
+                           ResizeCompletedCallback on_completed) {
+  std::thread([resize = resize, paths = std::move(paths),
+               on_completed = std::move(on_completed)]() mutable {
+    auto start = std::chrono::steady_clock::now();
+    size_t worker_count = std::min<size_t>(
+        std::max(std::thread::hardware_concurrency(), 1u), paths.size());
+
+    std::vector<std::string> results(paths.size());
+    std::atomic<size_t> next_index = 0;
+    MemoryBudget budget(kMemoryBudget);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < worker_count; i++) {
+      workers.emplace_back([&, resize]() mutable {
+        size_t index;
+        while ((index = next_index++) < paths.size()) {
+          size_t bytes = resize.EstimateMemory(paths[index]);
+          budget.Acquire(bytes);
+          std::string dest_path;
+          if (resize.Resize(paths[index], index, &dest_path)) {
+            results[index] = dest_path;
+          } else {
+            results[index] = paths[index];
+          }
+          budget.Release(bytes);
+        }
+      });
+    }
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    LOG_DEBUG("Resized %zu images with %zu workers in %lld ms", paths.size(),
+             worker_count, static_cast<long long>(elapsed.count()));
+
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT,
+        [](gpointer data) -> gboolean {
+          auto *completed = static_cast<CompletedData *>(data);
+          completed->on_completed(completed->paths);
+          return G_SOURCE_REMOVE;
+        },
+        new CompletedData{std::move(on_completed), std::move(results)},
+        [](gpointer data) { delete static_cast<CompletedData *>(data); });
+  }).detach();
+}
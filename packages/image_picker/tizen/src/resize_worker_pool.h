@@ -0,0 +1,29 @@
+// Copyright 2021 Samsung Electronics Co., Ltd. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_PLUGIN_RESIZE_WORKER_POOL_H_
+#define FLUTTER_PLUGIN_RESIZE_WORKER_POOL_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "image_resize.h"
+
+using ResizeCompletedCallback =
+    std::function<void(const std::vector<std::string>& paths)>;
+
+// Resizes images concurrently on background threads, bounded by the number
+// of cores and by an estimate of the memory the images need while they are
+// being resized.
+class ResizeWorkerPool {
+ public:
+  // Resizes |paths| with the options of |resize|. |on_completed| is called on
+  // the main thread with the resized paths in the order of |paths|, or with
+  // the source path for each image that has not been resized.
+  static void Run(const ImageResize& resize, std::vector<std::string> paths,
+                  ResizeCompletedCallback on_completed);
+};
+
+#endif  // FLUTTER_PLUGIN_RESIZE_WORKER_POOL_H_
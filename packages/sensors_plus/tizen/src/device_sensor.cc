@@ -4,6 +4,8 @@
 
 #include "device_sensor.h"
 
+#include <algorithm>
+
 #include "log.h"
 
 namespace {
@@ -41,9 +43,14 @@ DeviceSensor::DeviceSensor(SensorType sensor_type) : sensor_type_(sensor_type) {
 }
 
 DeviceSensor::~DeviceSensor() {
+  // Drop the pending samples instead of sending them to a sink that may
+  // already be gone.
+  callback_ = nullptr;
+  batch_.clear();
   if (is_listening_) {
     StopListen();
   }
+  RemoveFlushTimer();
 
   if (listener_) {
     sensor_destroy_listener(listener_);
@@ -68,11 +75,7 @@ bool DeviceSensor::StartListen(SensorEventCallback callback) {
       listener_, interval_ms_,
       [](sensor_h sensor, sensor_event_s *event, void *user_data) {
         auto *self = static_cast<DeviceSensor *>(user_data);
-        SensorEvent sensor_event;
-        for (int i = 0; i < event->value_count; i++) {
-          sensor_event.push_back(event->values[i]);
-        }
-        self->callback_(sensor_event);
+        self->OnSensorEvent(event);
       },
       this);
   if (ret != SENSOR_ERROR_NONE) {
@@ -100,6 +103,7 @@ void DeviceSensor::StopListen() {
     return;
   }
 
+  FlushBatch();
   int ret = sensor_listener_stop(listener_);
   if (ret != SENSOR_ERROR_NONE) {
     LOG_ERROR("Failed to stop listener: %s", get_error_message(ret));
@@ -108,6 +112,8 @@ void DeviceSensor::StopListen() {
   }
 
   is_listening_ = false;
+  sum_.clear();
+  sum_count_ = 0;
 
   ret = sensor_listener_unset_event_cb(listener_);
   if (ret != SENSOR_ERROR_NONE) {
@@ -117,6 +123,72 @@ void DeviceSensor::StopListen() {
   }
 }
 
+void DeviceSensor::SetBatching(int max_latency_ms, int decimation) {
+  FlushBatch();
+  max_latency_ms_ = max_latency_ms;
+  decimation_ = std::max(decimation, 1);
+  sum_.clear();
+  sum_count_ = 0;
+}
+
+void DeviceSensor::OnSensorEvent(sensor_event_s *event) {
+  SensorEvent values(event->values, event->values + event->value_count);
+  if (decimation_ > 1) {
+    if (sum_.size() != values.size()) {
+      sum_.assign(values.size(), 0.0);
+      sum_count_ = 0;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+      sum_[i] += values[i];
+    }
+    if (++sum_count_ < decimation_) {
+      return;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+      values[i] = sum_[i] / sum_count_;
+      sum_[i] = 0.0;
+    }
+    sum_count_ = 0;
+  }
+
+  if (max_latency_ms_ <= 0) {
+    callback_(values);
+    return;
+  }
+  batch_.push_back(static_cast<double>(event->timestamp));
+  batch_.insert(batch_.end(), values.begin(), values.end());
+  if (!flush_timer_) {
+    flush_timer_ = g_timeout_add(
+        max_latency_ms_,
+        [](gpointer data) -> gboolean {
+          auto *self = static_cast<DeviceSensor *>(data);
+          self->flush_timer_ = 0;
+          self->FlushBatch();
+          return G_SOURCE_REMOVE;
+        },
+        this);
+  }
+}
+
+void DeviceSensor::FlushBatch() {
+  RemoveFlushTimer();
+  if (batch_.empty()) {
+    return;
+  }
+  SensorEvent batch;
+  batch.swap(batch_);
+  if (callback_) {
+    callback_(batch);
+  }
+}
+
+void DeviceSensor::RemoveFlushTimer() {
+  if (flush_timer_) {
+    g_source_remove(flush_timer_);
+    flush_timer_ = 0;
+  }
+}
+
 void DeviceSensor::SetInterval(int interval_ms) {
   interval_ms_ = interval_ms;
 
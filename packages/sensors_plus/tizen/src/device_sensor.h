@@ -5,6 +5,7 @@
 #ifndef FLUTTER_PLUGIN_DEVICE_SENSOR_H_
 #define FLUTTER_PLUGIN_DEVICE_SENSOR_H_
 
+#include <glib.h>
 #include <sensor.h>
 #include <tizen.h>
 
@@ -15,7 +16,7 @@
 enum class SensorType { kAccelerometer, kGyroscope, kUserAccel, kMagnetometer };
 
 typedef std::vector<double> SensorEvent;
-typedef std::function<void(SensorEvent)> SensorEventCallback;
+typedef std::function<void(const SensorEvent &)> SensorEventCallback;
 
 class DeviceSensor {
  public:
@@ -32,7 +33,19 @@ class DeviceSensor {
 
   void SetInterval(int interval_ms);
 
+  // Averages every |decimation| samples into one, which also filters out
+  // noise above the resulting rate. If |max_latency_ms| is positive, the
+  // samples are delivered in batches at most |max_latency_ms| late, each
+  // packed as [timestamp (microseconds), value...] one after another.
+  void SetBatching(int max_latency_ms, int decimation);
+
  private:
+  void OnSensorEvent(sensor_event_s *event);
+
+  void FlushBatch();
+
+  void RemoveFlushTimer();
+
   SensorType sensor_type_;
   int interval_ms_ = 0;
   sensor_listener_h listener_ = nullptr;
@@ -40,6 +53,13 @@ class DeviceSensor {
   int last_error_ = TIZEN_ERROR_NONE;
 
   SensorEventCallback callback_ = nullptr;
+
+  int max_latency_ms_ = 0;
+  int decimation_ = 1;
+  SensorEvent sum_;
+  int sum_count_ = 0;
+  SensorEvent batch_;
+  guint flush_timer_ = 0;
 };
 
 #endif  // FLUTTER_PLUGIN_DEVICE_SENSOR_H_
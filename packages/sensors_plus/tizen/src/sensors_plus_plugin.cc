@@ -12,6 +12,7 @@
 #include <flutter/standard_method_codec.h>
 
 #include <memory>
+#include <string>
 
 #include "device_sensor.h"
 #include "log.h"
@@ -35,7 +36,8 @@ class DeviceSensorStreamHandler : public FlStreamHandler {
       std::unique_ptr<FlEventSink> &&events) override {
     events_ = std::move(events);
 
-    SensorEventCallback callback = [this](SensorEvent sensor_event) -> void {
+    SensorEventCallback callback =
+        [this](const SensorEvent &sensor_event) -> void {
       events_->Success(flutter::EncodableValue(sensor_event));
     };
     if (!sensor_->StartListen(callback)) {
@@ -144,6 +146,9 @@ class SensorsPlusPlugin : public flutter::Plugin {
         return;
       }
       magnetometer_sensor_->SetInterval(interval_ms_);
+    } else if (method_name == "setBatchMode") {
+      SetBatchMode(method_call, result.get());
+      return;
     } else {
       result->NotImplemented();
       return;
@@ -168,6 +173,51 @@ class SensorsPlusPlugin : public flutter::Plugin {
     return true;
   }
 
+  void SetBatchMode(const FlMethodCall &method_call, FlMethodResult *result) {
+    const auto *arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!arguments) {
+      result->Error("Invalid argument", "No arguments provided.");
+      return;
+    }
+
+    std::string sensor_name;
+    int32_t max_latency = 0;
+    int32_t decimation = 1;
+    for (const auto &[key, value] : *arguments) {
+      const auto *name = std::get_if<std::string>(&key);
+      if (!name) {
+        continue;
+      }
+      if (*name == "sensor" && std::holds_alternative<std::string>(value)) {
+        sensor_name = std::get<std::string>(value);
+      } else if (*name == "maxLatency" &&
+                 std::holds_alternative<int32_t>(value)) {
+        max_latency = std::get<int32_t>(value);
+      } else if (*name == "decimation" &&
+                 std::holds_alternative<int32_t>(value)) {
+        decimation = std::get<int32_t>(value);
+      }
+    }
+
+    DeviceSensor *sensor = nullptr;
+    if (sensor_name == "accelerometer") {
+      sensor = accelerometer_sensor_.get();
+    } else if (sensor_name == "gyroscope") {
+      sensor = gyroscope_sensor_.get();
+    } else if (sensor_name == "userAccelerometer") {
+      sensor = user_accelerometer_sensor_.get();
+    } else if (sensor_name == "magnetometer") {
+      sensor = magnetometer_sensor_.get();
+    }
+    if (!sensor) {
+      result->Error("Invalid argument", "Unknown sensor: " + sensor_name);
+      return;
+    }
+    sensor->SetBatching(max_latency, decimation);
+    result->Success();
+  }
+
   int32_t interval_ms_ = 0;
   std::unique_ptr<DeviceSensor> accelerometer_sensor_;
   std::unique_ptr<DeviceSensor> gyroscope_sensor_;
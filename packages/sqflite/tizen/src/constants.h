@@ -18,6 +18,7 @@ const std::string kMethodUpdate = "update";
 const std::string kMethodBatch = "batch";
 const std::string kMethodDeleteDatabase = "deleteDatabase";
 const std::string kMethodDatabaseExists = "databaseExists";
+const std::string kMethodQueryCursorNext = "queryCursorNext";
 const std::string kParamId = "id";
 const std::string kParamPath = "path";
 
@@ -26,6 +27,14 @@ const std::string kParamReadOnly = "readOnly";              // boolean
 const std::string kParamSingleInstance = "singleInstance";  // boolean
 const std::string kParamLogLevel = "logLevel";              // int
 
+// options
+const std::string kParamStatementCacheSize = "statementCacheSize";  // int
+const std::string kParamWalMode = "walMode";                        // boolean
+const std::string kParamSynchronous = "synchronous";                // string
+const std::string kParamMmapSize = "mmapSize";                      // int
+const std::string kParamCacheSize = "cacheSize";                    // int
+const std::string kParamReaderCount = "readerCount";                // int
+
 // true when entering, false when leaving, null otherwise
 const std::string kParamInTransaction = "inTransaction";
 
@@ -43,9 +52,20 @@ const std::string kParamColumns = "columns";
 const std::string kParamRows = "rows";
 const std::string kParamDatabases = "databases";
 
+// cursor queries
+const std::string kParamCursorPageSize = "cursorPageSize";  // int
+const std::string kParamCursorId = "cursorId";              // int
+const std::string kParamCancel = "cancel";                  // boolean
+
 // debugMode
 const std::string kParamCmd = "cmd";  // debugMode cmd: get/set
 const std::string kCmdGet = "get";
+const std::string kParamStatementCache = "statementCache";
+const std::string kParamSize = "size";
+const std::string kParamCapacity = "capacity";
+const std::string kParamHits = "hits";
+const std::string kParamMisses = "misses";
+const std::string kParamEvictions = "evictions";
 
 // in batch
 const std::string kParamOperations = "operations";
@@ -6,6 +6,7 @@
 #include <list>
 #include <variant>
 
+#include "constants.h"
 #include "errors.h"
 #include "log.h"
 #include "log_level.h"
@@ -13,10 +14,12 @@
 namespace sqflite_database {
 
 DatabaseManager::~DatabaseManager() {
-  for (auto &&statement : statement_cache_) {
-    FinalizeStmt(statement.second);
-    statement.second = nullptr;
+  for (auto &&cursor : cursors_) {
+    FinalizeStmt(cursor.second.statement);
   }
+  cursors_.clear();
+
+  statement_cache_.Clear();
 
   Close(true);
 }
@@ -25,7 +28,7 @@ void DatabaseManager::ThrowCurrentDatabaseError() {
   throw sqflite_errors::DatabaseError(GetErrorCode(), GetErrorMsg());
 }
 
-void DatabaseManager::Open() {
+void DatabaseManager::Open(const OpenOptions &options) {
   int result_code =
       sqlite3_open_v2(path_.c_str(), &database_,
                       SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
@@ -38,9 +41,10 @@ void DatabaseManager::Open() {
     Close(false);
     ThrowCurrentDatabaseError();
   }
+  Configure(options, false);
 }
 
-void DatabaseManager::OpenReadOnly() {
+void DatabaseManager::OpenReadOnly(const OpenOptions &options) {
   int result_code =
       sqlite3_open_v2(path_.c_str(), &database_, SQLITE_OPEN_READONLY, NULL);
   if (result_code != SQLITE_OK) {
@@ -52,6 +56,39 @@ void DatabaseManager::OpenReadOnly() {
     Close(false);
     ThrowCurrentDatabaseError();
   }
+  Configure(options, true);
+}
+
+void DatabaseManager::Configure(const OpenOptions &options, bool read_only) {
+  try {
+    // The journal mode is persistent, so it is only set by the writer.
+    if (options.wal_mode && !read_only) {
+      ExecutePragma("PRAGMA journal_mode=WAL");
+    }
+    if (options.synchronous) {
+      ExecutePragma("PRAGMA synchronous=" + *options.synchronous);
+    }
+    if (options.mmap_size) {
+      ExecutePragma("PRAGMA mmap_size=" + std::to_string(*options.mmap_size));
+    }
+    if (options.cache_size) {
+      ExecutePragma("PRAGMA cache_size=" +
+                    std::to_string(*options.cache_size));
+    }
+  } catch (const sqflite_errors::DatabaseError &) {
+    Close(false);
+    throw;
+  }
+}
+
+void DatabaseManager::ExecutePragma(const std::string &sql) {
+  if (sqflite_log_level::HasSqlLevel(log_level_)) {
+    LOG_DEBUG("%s", sql.c_str());
+  }
+  if (sqlite3_exec(database_, sql.c_str(), nullptr, nullptr, nullptr) !=
+      SQLITE_OK) {
+    ThrowCurrentDatabaseError();
+  }
 }
 
 const char *DatabaseManager::GetErrorMsg() { return sqlite3_errmsg(database_); }
@@ -60,6 +97,20 @@ int DatabaseManager::GetErrorCode() {
   return sqlite3_extended_errcode(database_);
 }
 
+void DatabaseManager::SetStatementCacheSize(size_t size) {
+  statement_cache_.SetCapacity(size);
+}
+
+int64_t DatabaseManager::GetChanges() { return sqlite3_changes(database_); }
+
+int64_t DatabaseManager::GetLastInsertRowId() {
+  return sqlite3_last_insert_rowid(database_);
+}
+
+bool DatabaseManager::InTransaction() {
+  return sqlite3_get_autocommit(database_) == 0;
+}
+
 void DatabaseManager::Close(bool raise_error) {
   int result_code = sqlite3_close_v2(database_);
   database_ = nullptr;
@@ -69,12 +120,13 @@ void DatabaseManager::Close(bool raise_error) {
 }
 
 void DatabaseManager::BindStmtParams(DatabaseManager::Statement statement,
-                                     SQLParameters parameters) {
+                                     const SQLParameters &parameters,
+                                     sqlite3_destructor_type destructor) {
   int result_code = SQLITE_OK;
   const int parameters_length = parameters.size();
   for (int i = 0; i < parameters_length; i++) {
     auto idx = i + 1;
-    auto parameter = parameters[i];
+    const auto &parameter = parameters[i];
     switch (parameter.index()) {
       case 0: {
         result_code = sqlite3_bind_null(statement, idx);
@@ -101,51 +153,56 @@ void DatabaseManager::BindStmtParams(DatabaseManager::Statement statement,
         break;
       }
       case 5: {
-        auto value = std::get<std::string>(parameter);
+        const auto &value = std::get<std::string>(parameter);
         result_code = sqlite3_bind_text(statement, idx, value.c_str(),
-                                        value.size(), SQLITE_TRANSIENT);
+                                        value.size(), destructor);
         break;
       }
       case 6: {
-        auto vector = std::get<std::vector<uint8_t>>(parameter);
+        const auto &vector = std::get<std::vector<uint8_t>>(parameter);
         result_code = sqlite3_bind_blob(statement, idx, vector.data(),
-                                        (int)vector.size(), SQLITE_TRANSIENT);
+                                        (int)vector.size(), destructor);
         break;
       }
       case 7: {
-        auto vector = std::get<std::vector<int32_t>>(parameter);
+        const auto &vector = std::get<std::vector<int32_t>>(parameter);
         result_code = sqlite3_bind_blob(statement, idx, vector.data(),
-                                        (int)vector.size(), SQLITE_TRANSIENT);
+                                        (int)vector.size(), destructor);
         break;
       }
       case 8: {
-        auto vector = std::get<std::vector<int64_t>>(parameter);
+        const auto &vector = std::get<std::vector<int64_t>>(parameter);
         result_code = sqlite3_bind_blob(statement, idx, vector.data(),
-                                        (int)vector.size(), SQLITE_TRANSIENT);
+                                        (int)vector.size(), destructor);
         break;
       }
       case 9: {
-        auto vector = std::get<std::vector<double>>(parameter);
+        const auto &vector = std::get<std::vector<double>>(parameter);
         result_code = sqlite3_bind_blob(statement, idx, vector.data(),
-                                        (int)vector.size(), SQLITE_TRANSIENT);
+                                        (int)vector.size(), destructor);
         break;
       }
       case 10: {
-        auto value = std::get<flutter::EncodableList>(parameter);
-        std::vector<uint8_t> vector;
+        const auto &value = std::get<flutter::EncodableList>(parameter);
         // Only  a list of uint8_t for flutter EncodableValue is supported
-        // to store it as a BLOB, otherwise a DatabaseError is triggered
-        try {
-          for (auto item : value) {
-            vector.push_back(std::get<int>(item));
+        // to store it as a BLOB, otherwise a DatabaseError is triggered.
+        // The converted buffer is handed over to SQLite, which frees it.
+        auto *buffer = static_cast<uint8_t *>(sqlite3_malloc64(value.size()));
+        if (buffer == nullptr && !value.empty()) {
+          throw sqflite_errors::DatabaseError(SQLITE_NOMEM, "out of memory");
+        }
+        for (size_t j = 0; j < value.size(); j++) {
+          const auto *item = std::get_if<int32_t>(&value[j]);
+          if (item == nullptr) {
+            sqlite3_free(buffer);
+            throw sqflite_errors::DatabaseError(
+                sqflite_errors::kUnknownErrorCode,
+                "statement parameter is not supported");
           }
-        } catch (const std::bad_variant_access) {
-          throw sqflite_errors::DatabaseError(
-              sqflite_errors::kUnknownErrorCode,
-              "statement parameter is not supported");
+          buffer[j] = static_cast<uint8_t>(*item);
         }
-        result_code = sqlite3_bind_blob(statement, idx, vector.data(),
-                                        (int)vector.size(), SQLITE_TRANSIENT);
+        result_code = sqlite3_bind_blob64(statement, idx, buffer, value.size(),
+                                          sqlite3_free);
         break;
       }
       default: {
@@ -160,15 +217,12 @@ void DatabaseManager::BindStmtParams(DatabaseManager::Statement statement,
   }
 }
 
-DatabaseManager::Statement DatabaseManager::PrepareStmt(std::string sql) {
-  auto cache_entry = statement_cache_.find(sql);
-  if (cache_entry != statement_cache_.end()) {
-    DatabaseManager::Statement statement = cache_entry->second;
-    sqlite3_reset(statement);
-    sqlite3_clear_bindings(statement);
+DatabaseManager::Statement DatabaseManager::PrepareStmt(
+    const std::string &sql) {
+  DatabaseManager::Statement statement = statement_cache_.Get(sql);
+  if (statement != nullptr) {
     return statement;
   } else {
-    DatabaseManager::Statement statement;
     int result_code =
         sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr);
     if (result_code) {
@@ -176,7 +230,7 @@ DatabaseManager::Statement DatabaseManager::PrepareStmt(std::string sql) {
       ThrowCurrentDatabaseError();
     }
     if (statement != nullptr) {
-      statement_cache_[sql] = statement;
+      statement_cache_.Put(sql, statement);
     }
     return statement;
   }
@@ -206,60 +260,96 @@ const char *DatabaseManager::GetColumnName(DatabaseManager::Statement statement,
   return sqlite3_column_name(statement, column_index);
 }
 
-std::pair<Columns, Resultset> DatabaseManager::QueryStmt(
+flutter::EncodableList DatabaseManager::GetStmtColumns(
     DatabaseManager::Statement statement) {
-  Columns columns;
-  Resultset resultset;
+  flutter::EncodableList columns;
   const int columns_count = GetStmtColumnsCount(statement);
-  int result_code = SQLITE_OK;
+  columns.reserve(columns_count);
+  for (int i = 0; i < columns_count; i++) {
+    columns.emplace_back(std::string(GetColumnName(statement, i)));
+  }
+  return columns;
+}
+
+flutter::EncodableValue DatabaseManager::GetColumnValue(
+    DatabaseManager::Statement statement, int column_index) {
+  switch (GetColumnType(statement, column_index)) {
+    case SQLITE_INTEGER:
+      return flutter::EncodableValue(
+          (int64_t)sqlite3_column_int64(statement, column_index));
+    case SQLITE_FLOAT:
+      return flutter::EncodableValue(
+          sqlite3_column_double(statement, column_index));
+    case SQLITE_TEXT: {
+      // sqlite3_column_bytes must be called after sqlite3_column_text.
+      const char *text = reinterpret_cast<const char *>(
+          sqlite3_column_text(statement, column_index));
+      return flutter::EncodableValue(
+          std::string(text, sqlite3_column_bytes(statement, column_index)));
+    }
+    case SQLITE_BLOB: {
+      const uint8_t *blob = reinterpret_cast<const uint8_t *>(
+          sqlite3_column_blob(statement, column_index));
+      return flutter::EncodableValue(std::vector<uint8_t>(
+          blob, blob + sqlite3_column_bytes(statement, column_index)));
+    }
+    case SQLITE_NULL:
+    default:
+      return flutter::EncodableValue();
+  }
+}
+
+flutter::EncodableValue DatabaseManager::GetStmtRow(
+    DatabaseManager::Statement statement, const flutter::EncodableList &columns,
+    bool as_map) {
+  const int columns_count = columns.size();
+  if (as_map) {
+    flutter::EncodableMap row;
+    for (int i = 0; i < columns_count; i++) {
+      row.emplace(columns[i], GetColumnValue(statement, i));
+    }
+    return flutter::EncodableValue(std::move(row));
+  }
+  flutter::EncodableList row;
+  row.reserve(columns_count);
   for (int i = 0; i < columns_count; i++) {
-    auto column_name = GetColumnName(statement, i);
-    columns.push_back(std::string(column_name));
+    row.push_back(GetColumnValue(statement, i));
+  }
+  return flutter::EncodableValue(std::move(row));
+}
+
+flutter::EncodableValue DatabaseManager::BuildQueryResult(
+    flutter::EncodableList columns, flutter::EncodableList rows,
+    bool as_map_list) {
+  if (as_map_list) {
+    return flutter::EncodableValue(std::move(rows));
+  }
+  flutter::EncodableMap result;
+  if (rows.empty()) {
+    return flutter::EncodableValue(std::move(result));
   }
+  result.emplace(flutter::EncodableValue(sqflite_constants::kParamColumns),
+                 flutter::EncodableValue(std::move(columns)));
+  result.emplace(flutter::EncodableValue(sqflite_constants::kParamRows),
+                 flutter::EncodableValue(std::move(rows)));
+  return flutter::EncodableValue(std::move(result));
+}
+
+flutter::EncodableValue DatabaseManager::QueryStmt(
+    DatabaseManager::Statement statement, bool as_map_list) {
+  flutter::EncodableList columns = GetStmtColumns(statement);
+  flutter::EncodableList rows;
+  int result_code = SQLITE_OK;
   do {
     result_code = sqlite3_step(statement);
     if (result_code == SQLITE_ROW) {
-      Result result;
-      for (int i = 0; i < columns_count; i++) {
-        ResultValue value;
-        auto column_type = GetColumnType(statement, i);
-        switch (column_type) {
-          case SQLITE_INTEGER:
-            value = (int64_t)sqlite3_column_int64(statement, i);
-            result.push_back(value);
-            break;
-          case SQLITE_FLOAT:
-            value = sqlite3_column_double(statement, i);
-            result.push_back(value);
-            break;
-          case SQLITE_TEXT:
-            value =
-                std::string((const char *)sqlite3_column_text(statement, i));
-            result.push_back(value);
-            break;
-          case SQLITE_BLOB: {
-            const uint8_t *blob = reinterpret_cast<const uint8_t *>(
-                sqlite3_column_blob(statement, i));
-            std::vector<uint8_t> v(&blob[0],
-                                   &blob[sqlite3_column_bytes(statement, i)]);
-            result.push_back(v);
-            break;
-          }
-          case SQLITE_NULL:
-            value = nullptr;
-            result.push_back(value);
-            break;
-          default:
-            break;
-        }
-      }
-      resultset.push_back(result);
+      rows.push_back(GetStmtRow(statement, columns, as_map_list));
     }
   } while (result_code == SQLITE_ROW);
   if (result_code != SQLITE_DONE) {
     ThrowCurrentDatabaseError();
   }
-  return std::make_pair(columns, resultset);
+  return BuildQueryResult(std::move(columns), std::move(rows), as_map_list);
 }
 
 void DatabaseManager::FinalizeStmt(DatabaseManager::Statement statement) {
@@ -270,18 +360,111 @@ void DatabaseManager::LogQuery(Statement statement) {
   LOG_DEBUG("%s", sqlite3_expanded_sql(statement));
 }
 
-std::pair<Columns, Resultset> DatabaseManager::Query(std::string sql,
-                                                     SQLParameters parameters) {
-  auto statement = PrepareStmt(sql);
+flutter::EncodableValue DatabaseManager::Query(const std::string &sql,
+                                               const SQLParameters &parameters,
+                                               bool as_map_list) {
+  return Query(PrepareStmt(sql), parameters, as_map_list);
+}
+
+DatabaseManager::Statement DatabaseManager::Prepare(const std::string &sql) {
+  return PrepareStmt(sql);
+}
+
+flutter::EncodableValue DatabaseManager::Query(
+    DatabaseManager::Statement statement, const SQLParameters &parameters,
+    bool as_map_list) {
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
   BindStmtParams(statement, parameters);
   if (sqflite_log_level::HasSqlLevel(log_level_)) {
     LogQuery(statement);
   }
-  return QueryStmt(statement);
+  return QueryStmt(statement, as_map_list);
+}
+
+int DatabaseManager::QueryCursor(const std::string &sql,
+                                 const SQLParameters &parameters,
+                                 int page_size) {
+  // Cursor statements are not cached, since they stay in use until the
+  // cursor is closed.
+  Statement statement;
+  int result_code =
+      sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr);
+  if (result_code) {
+    FinalizeStmt(statement);
+    ThrowCurrentDatabaseError();
+  }
+  try {
+    // The parameters may be gone by the time the next page is read.
+    BindStmtParams(statement, parameters, SQLITE_TRANSIENT);
+  } catch (const sqflite_errors::DatabaseError &) {
+    FinalizeStmt(statement);
+    throw;
+  }
+  if (sqflite_log_level::HasSqlLevel(log_level_)) {
+    LogQuery(statement);
+  }
+  const int cursor_id = ++last_cursor_id_;
+  cursors_[cursor_id] = Cursor{statement, page_size > 0 ? page_size : 1, false};
+  return cursor_id;
+}
+
+flutter::EncodableValue DatabaseManager::QueryCursorNext(int cursor_id) {
+  auto iter = cursors_.find(cursor_id);
+  if (iter == cursors_.end()) {
+    throw sqflite_errors::DatabaseError(
+        sqflite_errors::kUnknownErrorCode,
+        ("cursor " + std::to_string(cursor_id) + " not found").c_str());
+  }
+  Cursor &cursor = iter->second;
+  flutter::EncodableList columns = GetStmtColumns(cursor.statement);
+  flutter::EncodableList rows;
+  rows.reserve(cursor.page_size);
+  int result_code = SQLITE_ROW;
+  if (!cursor.row_pending) {
+    result_code = sqlite3_step(cursor.statement);
+  }
+  while (result_code == SQLITE_ROW) {
+    if (static_cast<int>(rows.size()) == cursor.page_size) {
+      // Leave the row for the next page, so that an exhausted cursor is
+      // detected without an extra empty page.
+      cursor.row_pending = true;
+      return BuildQueryResult(std::move(columns), std::move(rows), false);
+    }
+    rows.push_back(GetStmtRow(cursor.statement, columns, false));
+    result_code = sqlite3_step(cursor.statement);
+  }
+  if (result_code != SQLITE_DONE) {
+    const int error_code = GetErrorCode();
+    const std::string error_message = GetErrorMsg();
+    CloseCursor(cursor_id);
+    throw sqflite_errors::DatabaseError(error_code, error_message.c_str());
+  }
+  CloseCursor(cursor_id);
+  return BuildQueryResult(std::move(columns), std::move(rows), false);
+}
+
+bool DatabaseManager::HasCursor(int cursor_id) {
+  return cursors_.find(cursor_id) != cursors_.end();
+}
+
+void DatabaseManager::CloseCursor(int cursor_id) {
+  auto iter = cursors_.find(cursor_id);
+  if (iter != cursors_.end()) {
+    FinalizeStmt(iter->second.statement);
+    cursors_.erase(iter);
+  }
+}
+
+void DatabaseManager::Execute(const std::string &sql,
+                              const SQLParameters &parameters) {
+  Execute(PrepareStmt(sql), parameters);
 }
 
-void DatabaseManager::Execute(std::string sql, SQLParameters parameters) {
-  Statement statement = PrepareStmt(sql);
+void DatabaseManager::Execute(DatabaseManager::Statement statement,
+                              const SQLParameters &parameters) {
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
   BindStmtParams(statement, parameters);
   if (sqflite_log_level::HasSqlLevel(log_level_)) {
     LogQuery(statement);
@@ -5,21 +5,31 @@
 #include <sqlite3.h>
 
 #include <list>
+#include <optional>
 #include <string>
 
+#include "statement_cache.h"
+
 namespace sqflite_database {
 
 typedef sqlite3 *Database;
-typedef std::variant<int64_t, std::string, double, std::vector<uint8_t>,
-                     std::nullptr_t>
-    ResultValue;
-typedef std::vector<ResultValue> Result;
-typedef std::vector<Result> Resultset;
-typedef std::vector<std::string> Columns;
 typedef flutter::EncodableList SQLParameters;
 
+// Optional settings applied to a connection when it is opened.
+struct OpenOptions {
+  // Enables write-ahead logging, which lets readers run concurrently with a
+  // writer.
+  bool wal_mode = false;
+  // One of OFF, NORMAL, FULL or EXTRA.
+  std::optional<std::string> synchronous;
+  std::optional<int64_t> mmap_size;
+  std::optional<int64_t> cache_size;
+};
+
 class DatabaseManager {
  public:
+  typedef sqlite3_stmt *Statement;
+
   static const int kBusyTimeoutMs = 2500;
 
   DatabaseManager(std::string path, int database_id, bool single_instance,
@@ -36,31 +46,83 @@ class DatabaseManager {
   inline const bool single_instance() { return single_instance_; };
   inline const int log_level() { return log_level_; };
   inline const Database database() { return database_; };
+  inline const StatementCache &statement_cache() { return statement_cache_; };
 
-  void Open();
-  void OpenReadOnly();
+  void Open(const OpenOptions &options = OpenOptions());
+  void OpenReadOnly(const OpenOptions &options = OpenOptions());
   const char *GetErrorMsg();
   int GetErrorCode();
-  void Execute(std::string sql, SQLParameters parameters = SQLParameters());
-  std::pair<Columns, Resultset> Query(
-      std::string sql, SQLParameters parameters = SQLParameters());
+  void SetStatementCacheSize(size_t size);
+  // Number of rows changed by the most recent statement.
+  int64_t GetChanges();
+  int64_t GetLastInsertRowId();
+  bool InTransaction();
+  void Execute(const std::string &sql,
+               const SQLParameters &parameters = SQLParameters());
+  // Returns the rows either as a map of "columns" and "rows" lists, or as a
+  // list of column name to value maps if |as_map_list| is true.
+  flutter::EncodableValue Query(
+      const std::string &sql,
+      const SQLParameters &parameters = SQLParameters(),
+      bool as_map_list = false);
+
+  // Returns the (cached) prepared statement of |sql|, which can be run
+  // repeatedly with different parameters until another statement is
+  // prepared.
+  Statement Prepare(const std::string &sql);
+  void Execute(Statement statement, const SQLParameters &parameters);
+  flutter::EncodableValue Query(Statement statement,
+                                const SQLParameters &parameters,
+                                bool as_map_list = false);
+
+  // Runs |sql| and keeps its statement alive so that the rows can be read
+  // page by page with |QueryCursorNext|. Returns the id of the new cursor.
+  int QueryCursor(const std::string &sql, const SQLParameters &parameters,
+                  int page_size);
+  // Returns the next page of at most |page_size| rows of |cursor_id|. The
+  // cursor is closed once all its rows have been read.
+  flutter::EncodableValue QueryCursorNext(int cursor_id);
+  bool HasCursor(int cursor_id);
+  void CloseCursor(int cursor_id);
 
  private:
-  typedef sqlite3_stmt *Statement;
+  struct Cursor {
+    Statement statement;
+    int page_size;
+    // Whether the statement has already been stepped onto a row which has
+    // not been read yet.
+    bool row_pending;
+  };
 
   void Close(bool raise_error);
-  void BindStmtParams(Statement statement, SQLParameters parameters);
+  void Configure(const OpenOptions &options, bool read_only);
+  void ExecutePragma(const std::string &sql);
+  // Parameters are bound with SQLITE_STATIC by default, so they must outlive
+  // the execution of |statement|. Statements are always reset and their
+  // bindings cleared before being run again.
+  void BindStmtParams(Statement statement, const SQLParameters &parameters,
+                      sqlite3_destructor_type destructor = SQLITE_STATIC);
   void ExecuteStmt(Statement statement);
-  std::pair<Columns, Resultset> QueryStmt(Statement statement);
+  flutter::EncodableValue QueryStmt(Statement statement, bool as_map_list);
+  flutter::EncodableList GetStmtColumns(Statement statement);
+  flutter::EncodableValue GetStmtRow(Statement statement,
+                                     const flutter::EncodableList &columns,
+                                     bool as_map);
+  flutter::EncodableValue GetColumnValue(Statement statement, int column_index);
+  static flutter::EncodableValue BuildQueryResult(
+      flutter::EncodableList columns, flutter::EncodableList rows,
+      bool as_map_list);
   void FinalizeStmt(Statement statement);
-  Statement PrepareStmt(std::string sql);
+  Statement PrepareStmt(const std::string &sql);
   int GetStmtColumnsCount(Statement statement);
   int GetColumnType(Statement statement, int column_index);
   const char *GetColumnName(Statement statement, int column_index);
   void ThrowCurrentDatabaseError();
   void LogQuery(Statement statement);
 
-  std::map<std::string, Statement> statement_cache_;
+  StatementCache statement_cache_;
+  std::map<int, Cursor> cursors_;
+  int last_cursor_id_ = 0;
   std::string path_;
   int database_id_;
   bool single_instance_;
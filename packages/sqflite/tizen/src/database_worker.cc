@@ -0,0 +1,74 @@
+#include "database_worker.h"
+
+#include <glib.h>
+
+#include <thread>
+
+namespace sqflite_database {
+
+DatabaseWorker::DatabaseWorker() : state_(std::make_shared<State>()) {
+  std::thread(Run, state_).detach();
+}
+
+DatabaseWorker::~DatabaseWorker() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+  }
+  state_->condition.notify_one();
+}
+
+void DatabaseWorker::Post(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->tasks.push(std::move(task));
+    state_->pending++;
+  }
+  state_->condition.notify_one();
+}
+
+void DatabaseWorker::SetBeforeTask(Task before_task) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->before_task = std::move(before_task);
+}
+
+void DatabaseWorker::Run(std::shared_ptr<State> state) {
+  while (true) {
+    Task task;
+    Task before_task;
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->condition.wait(
+          lock, [&state] { return state->stopped || !state->tasks.empty(); });
+      if (state->tasks.empty()) {
+        // Stopped and drained.
+        return;
+      }
+      task = std::move(state->tasks.front());
+      state->tasks.pop();
+      before_task = state->before_task;
+    }
+    if (before_task) {
+      before_task();
+      before_task = nullptr;
+    }
+    task();
+    // Release the captures before the task is reported as completed.
+    task = nullptr;
+    state->pending--;
+  }
+}
+
+void RunOnMainThread(Task task) {
+  g_idle_add_full(
+      G_PRIORITY_DEFAULT,
+      [](gpointer data) -> gboolean {
+        auto *task = static_cast<Task *>(data);
+        (*task)();
+        return G_SOURCE_REMOVE;
+      },
+      new Task(std::move(task)),
+      [](gpointer data) { delete static_cast<Task *>(data); });
+}
+
+}  // namespace sqflite_database
@@ -0,0 +1,52 @@
+#ifndef SQFLITE_DATABASE_WORKER_H_
+#define SQFLITE_DATABASE_WORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+namespace sqflite_database {
+
+typedef std::function<void()> Task;
+
+// Runs the tasks of a single database serially on a dedicated thread, so that
+// statements never block the platform thread and independent databases can
+// be accessed in parallel.
+class DatabaseWorker {
+ public:
+  DatabaseWorker();
+  ~DatabaseWorker();
+
+  void Post(Task task);
+
+  // Sets a function which is run on the worker thread before each task.
+  void SetBeforeTask(Task before_task);
+
+  // Number of tasks posted which have not completed yet.
+  inline size_t pending() const { return state_->pending; };
+
+ private:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::queue<Task> tasks;
+    Task before_task;
+    std::atomic<size_t> pending = 0;
+    bool stopped = false;
+  };
+
+  static void Run(std::shared_ptr<State> state);
+
+  // Shared with the worker thread, which outlives this object until all the
+  // pending tasks have been run.
+  std::shared_ptr<State> state_;
+};
+
+// Runs |task| on the platform thread.
+void RunOnMainThread(Task task);
+
+}  // namespace sqflite_database
+#endif  // SQFLITE_DATABASE_WORKER_H_
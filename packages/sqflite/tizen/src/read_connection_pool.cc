@@ -0,0 +1,64 @@
+#include "read_connection_pool.h"
+
+namespace sqflite_database {
+
+ReadConnectionPool::ReadConnectionPool(const std::string &path,
+                                       int database_id, int log_level,
+                                       size_t size, size_t statement_cache_size,
+                                       const OpenOptions &options) {
+  for (size_t i = 0; i < size; i++) {
+    auto connection = std::make_unique<Connection>();
+    connection->database = std::make_shared<DatabaseManager>(
+        path, database_id, false, log_level);
+    connection->database->OpenReadOnly(options);
+    connection->database->SetStatementCacheSize(statement_cache_size);
+    connections_.push_back(std::move(connection));
+  }
+}
+
+ReadConnectionPool::~ReadConnectionPool() {
+  // The connections are closed when |connections_| is destroyed, as the
+  // completed tasks hold no reference to them.
+  Wait();
+}
+
+void ReadConnectionPool::Post(ReadTask task) {
+  Connection *connection = connections_[0].get();
+  for (const auto &candidate : connections_) {
+    if (candidate->worker.pending() < connection->worker.pending()) {
+      connection = candidate.get();
+    }
+  }
+  PostTo(connection, std::move(task));
+}
+
+void ReadConnectionPool::SetStatementCacheSize(size_t size) {
+  for (const auto &connection : connections_) {
+    PostTo(connection.get(),
+           [size](std::shared_ptr<DatabaseManager> database) {
+             database->SetStatementCacheSize(size);
+           });
+  }
+}
+
+void ReadConnectionPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait(lock, [this] { return running_ == 0; });
+}
+
+void ReadConnectionPool::PostTo(Connection *connection, ReadTask task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_++;
+  }
+  connection->worker.Post([this, connection, task = std::move(task)]() {
+    task(connection->database);
+    // Notify with |mutex_| held, since the pool may be destroyed as soon as
+    // Wait returns.
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_--;
+    condition_.notify_all();
+  });
+}
+
+}  // namespace sqflite_database
@@ -0,0 +1,57 @@
+#ifndef SQFLITE_READ_CONNECTION_POOL_H_
+#define SQFLITE_READ_CONNECTION_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "database_manager.h"
+#include "database_worker.h"
+
+namespace sqflite_database {
+
+// Read-only connections to a database in WAL mode, each with its own worker
+// thread, so that queries can run concurrently with each other and with the
+// writer connection.
+class ReadConnectionPool {
+ public:
+  typedef std::function<void(std::shared_ptr<DatabaseManager>)> ReadTask;
+
+  // Throws a DatabaseError if a connection cannot be opened.
+  ReadConnectionPool(const std::string &path, int database_id, int log_level,
+                     size_t size, size_t statement_cache_size,
+                     const OpenOptions &options);
+  // Waits for the posted tasks and closes the connections, so it must not
+  // be called on the platform thread.
+  ~ReadConnectionPool();
+
+  // Runs |task| on the connection with the fewest pending tasks.
+  void Post(ReadTask task);
+  void SetStatementCacheSize(size_t size);
+
+  // Blocks until the tasks posted so far have completed.
+  void Wait();
+
+  inline size_t size() const { return connections_.size(); };
+
+ private:
+  struct Connection {
+    std::shared_ptr<DatabaseManager> database;
+    DatabaseWorker worker;
+  };
+
+  // Runs |task| on |connection| and counts it until it completes.
+  void PostTo(Connection *connection, ReadTask task);
+
+  std::vector<std::unique_ptr<Connection>> connections_;
+  // Guards |running_|, the number of tasks posted but not completed.
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t running_ = 0;
+};
+
+}  // namespace sqflite_database
+#endif  // SQFLITE_READ_CONNECTION_POOL_H_
@@ -11,7 +11,10 @@
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar.h>
 #include <flutter/standard_method_codec.h>
+#include <strings.h>
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <list>
 #include <map>
@@ -21,13 +24,15 @@
 
 #include "constants.h"
 #include "database_manager.h"
+#include "database_worker.h"
+#include "read_connection_pool.h"
 #include "errors.h"
 #include "log.h"
 #include "log_level.h"
 
 template <typename T>
-bool GetValueFromEncodableMap(flutter::EncodableMap &map, std::string key,
-                              T &out) {
+bool GetValueFromEncodableMap(const flutter::EncodableMap &map,
+                              const std::string &key, T &out) {
   auto iter = map.find(flutter::EncodableValue(key));
   if (iter != map.end() && !iter->second.IsNull()) {
     if (auto pval = std::get_if<T>(&iter->second)) {
@@ -38,26 +43,37 @@ bool GetValueFromEncodableMap(flutter::EncodableMap &map, std::string key,
   return false;
 }
 
-struct DBResultVisitor {
-  flutter::EncodableValue operator()(int64_t value) {
-    return flutter::EncodableValue(value);
-  };
-  flutter::EncodableValue operator()(std::string value) {
-    return flutter::EncodableValue(value);
-  };
-  flutter::EncodableValue operator()(double value) {
-    return flutter::EncodableValue(value);
-  };
-  flutter::EncodableValue operator()(std::vector<uint8_t> value) {
-    return flutter::EncodableValue(value);
-  };
-  flutter::EncodableValue operator()(std::nullptr_t value) {
-    return flutter::EncodableValue();
-  };
-};
+bool GetInt64FromEncodableMap(const flutter::EncodableMap &map,
+                              const std::string &key, int64_t &out) {
+  auto iter = map.find(flutter::EncodableValue(key));
+  if (iter != map.end()) {
+    if (auto pval = std::get_if<int32_t>(&iter->second)) {
+      out = *pval;
+      return true;
+    }
+    if (auto pval = std::get_if<int64_t>(&iter->second)) {
+      out = *pval;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+const T *GetPointerFromEncodableMap(const flutter::EncodableMap &map,
+                                    const std::string &key) {
+  auto iter = map.find(flutter::EncodableValue(key));
+  if (iter != map.end()) {
+    return std::get_if<T>(&iter->second);
+  }
+  return nullptr;
+}
 
 class SqflitePlugin : public flutter::Plugin {
  public:
+  typedef std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>
+      SharedMethodResult;
+
   static void RegisterWithRegistrar(flutter::PluginRegistrar *registrar) {
     auto channel =
         std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
@@ -98,6 +114,8 @@ class SqflitePlugin : public flutter::Plugin {
       OnExecuteCall(method_call, std::move(result));
     } else if (method_name == sqflite_constants::kMethodQuery) {
       OnQueryCall(method_call, std::move(result));
+    } else if (method_name == sqflite_constants::kMethodQueryCursorNext) {
+      OnQueryCursorNextCall(method_call, std::move(result));
     } else if (method_name == sqflite_constants::kMethodInsert) {
       OnInsertCall(method_call, std::move(result));
     } else if (method_name == sqflite_constants::kMethodUpdate) {
@@ -135,6 +153,49 @@ class SqflitePlugin : public flutter::Plugin {
     return result;
   }
 
+  static std::shared_ptr<sqflite_database::DatabaseWorker> GetDatabaseWorker(
+      int database_id) {
+    std::shared_ptr<sqflite_database::DatabaseWorker> result = nullptr;
+    auto itr = database_workers_.find(database_id);
+    if (itr != database_workers_.end()) {
+      result = itr->second;
+    }
+    return result;
+  }
+
+  // Method results must be delivered on the platform thread, while database
+  // tasks run on their worker thread.
+  static void ReplySuccess(
+      SharedMethodResult result,
+      flutter::EncodableValue response = flutter::EncodableValue()) {
+    sqflite_database::RunOnMainThread(
+        [result, response = std::move(response)]() {
+          result->Success(response);
+        });
+  }
+
+  static void ReplyError(
+      SharedMethodResult result, std::string error_code,
+      std::string error_message,
+      flutter::EncodableValue error_details = flutter::EncodableValue()) {
+    sqflite_database::RunOnMainThread(
+        [result, error_code = std::move(error_code),
+         error_message = std::move(error_message),
+         error_details = std::move(error_details)]() {
+          result->Error(error_code, error_message, error_details);
+        });
+  }
+
+  static std::shared_ptr<sqflite_database::ReadConnectionPool>
+  GetDatabaseReaders(int database_id) {
+    std::shared_ptr<sqflite_database::ReadConnectionPool> result = nullptr;
+    auto itr = database_readers_.find(database_id);
+    if (itr != database_readers_.end()) {
+      result = itr->second;
+    }
+    return result;
+  }
+
   bool IsDatabaseOpened(int database_id) {
     auto itr = database_map_.find(database_id);
     if (itr != database_map_.end()) {
@@ -144,9 +205,9 @@ class SqflitePlugin : public flutter::Plugin {
   }
 
   static void HandleQueryException(
-      sqflite_errors::DatabaseError exception, std::string sql,
-      sqflite_database::SQLParameters sql_parameters,
-      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+      const sqflite_errors::DatabaseError &exception, const std::string &sql,
+      const sqflite_database::SQLParameters &sql_parameters,
+      SharedMethodResult result) {
     flutter::EncodableMap exception_map;
     exception_map.insert(
         std::pair<flutter::EncodableValue, flutter::EncodableValue>(
@@ -156,14 +217,14 @@ class SqflitePlugin : public flutter::Plugin {
         std::pair<flutter::EncodableValue, flutter::EncodableList>(
             flutter::EncodableValue(sqflite_constants::kParamSqlArguments),
             sql_parameters));
-    result->Error(sqflite_constants::kErrorDatabase, exception.what(),
-                  flutter::EncodableValue(exception_map));
+    ReplyError(result, sqflite_constants::kErrorDatabase, exception.what(),
+               flutter::EncodableValue(exception_map));
   }
 
   void OnDebugCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     std::string command;
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamCmd, command);
@@ -193,6 +254,14 @@ class SqflitePlugin : public flutter::Plugin {
                 flutter::EncodableValue(sqflite_constants::kParamLogLevel),
                 flutter::EncodableValue(database->log_level())));
           }
+          info.insert(std::make_pair(
+              flutter::EncodableValue(sqflite_constants::kParamStatementCache),
+              GetStatementCacheInfo(database->statement_cache())));
+          if (auto readers = GetDatabaseReaders(id)) {
+            info.insert(std::make_pair(
+                flutter::EncodableValue(sqflite_constants::kParamReaderCount),
+                flutter::EncodableValue(int64_t(readers->size()))));
+          }
           databases_info.insert(
               std::make_pair(flutter::EncodableValue(id), info));
         }
@@ -204,10 +273,31 @@ class SqflitePlugin : public flutter::Plugin {
     result->Success(flutter::EncodableValue(map));
   }
 
+  static flutter::EncodableValue GetStatementCacheInfo(
+      const sqflite_database::StatementCache &cache) {
+    flutter::EncodableMap info;
+    info.insert(
+        std::make_pair(flutter::EncodableValue(sqflite_constants::kParamSize),
+                       flutter::EncodableValue(int64_t(cache.size()))));
+    info.insert(std::make_pair(
+        flutter::EncodableValue(sqflite_constants::kParamCapacity),
+        flutter::EncodableValue(int64_t(cache.capacity()))));
+    info.insert(
+        std::make_pair(flutter::EncodableValue(sqflite_constants::kParamHits),
+                       flutter::EncodableValue(int64_t(cache.hits()))));
+    info.insert(std::make_pair(
+        flutter::EncodableValue(sqflite_constants::kParamMisses),
+        flutter::EncodableValue(int64_t(cache.misses()))));
+    info.insert(std::make_pair(
+        flutter::EncodableValue(sqflite_constants::kParamEvictions),
+        flutter::EncodableValue(int64_t(cache.evictions()))));
+    return flutter::EncodableValue(info);
+  }
+
   void OnExecuteCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     int database_id;
     std::string sql;
@@ -227,52 +317,56 @@ class SqflitePlugin : public flutter::Plugin {
                         std::to_string(database_id));
       return;
     }
-    try {
-      Execute(database, sql, parameters);
-    } catch (const sqflite_errors::DatabaseError &exception) {
-      result->Error(sqflite_constants::kErrorDatabase, exception.what());
-      return;
-    }
-    result->Success();
+    SharedMethodResult shared_result = std::move(result);
+    auto worker = GetDatabaseWorker(database_id);
+    worker->Post([database, sql = std::move(sql),
+                  parameters = std::move(parameters), shared_result]() {
+      try {
+        Execute(database, sql, parameters);
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        ReplyError(shared_result, sqflite_constants::kErrorDatabase,
+                   exception.what());
+        return;
+      }
+      ReplySuccess(shared_result);
+    });
   }
 
-  void Execute(std::shared_ptr<sqflite_database::DatabaseManager> database,
-               std::string sql, sqflite_database::SQLParameters parameters) {
+  static void Execute(
+      std::shared_ptr<sqflite_database::DatabaseManager> database,
+      const std::string &sql,
+      const sqflite_database::SQLParameters &parameters) {
     database->Execute(sql, parameters);
   }
 
-  int64_t QueryUpdateChanges(
+  static int64_t QueryUpdateChanges(
       std::shared_ptr<sqflite_database::DatabaseManager> database) {
-    std::string changes_sql = "SELECT changes();";
-    auto [_, resultset] = database->Query(changes_sql);
-
-    auto first_result = resultset[0];
-    return std::get<int64_t>(first_result[0]);
+    return database->GetChanges();
   }
 
-  std::pair<int64_t, int64_t> QueryInsertChanges(
+  static std::pair<int64_t, int64_t> QueryInsertChanges(
       std::shared_ptr<sqflite_database::DatabaseManager> database) {
-    std::string changes_sql = "SELECT changes(), last_insert_rowid();";
-
-    auto [_, resultset] = database->Query(changes_sql);
-    auto first_result = resultset[0];
-    auto changes = std::get<int64_t>(first_result[0]);
-    int last_id = 0;
+    auto changes = database->GetChanges();
+    int64_t last_id = 0;
     if (changes > 0) {
-      last_id = std::get<int64_t>(first_result[1]);
+      last_id = database->GetLastInsertRowId();
     }
     return std::make_pair(changes, last_id);
   }
 
-  flutter::EncodableValue Update(
+  static flutter::EncodableValue Update(
       std::shared_ptr<sqflite_database::DatabaseManager> database,
-      std::string sql, sqflite_database::SQLParameters parameters,
+      const std::string &sql, const sqflite_database::SQLParameters &parameters,
       bool no_result) {
     database->Execute(sql, parameters);
     if (no_result) {
       return flutter::EncodableValue();
     }
+    return GetUpdateResult(database);
+  }
 
+  static flutter::EncodableValue GetUpdateResult(
+      std::shared_ptr<sqflite_database::DatabaseManager> database) {
     auto changes = QueryUpdateChanges(database);
     if (changes > 0 && sqflite_log_level::HasSqlLevel(database->log_level())) {
       LOG_DEBUG("Number of rows changed: %d", changes);
@@ -280,15 +374,19 @@ class SqflitePlugin : public flutter::Plugin {
     return flutter::EncodableValue(changes);
   }
 
-  flutter::EncodableValue Insert(
+  static flutter::EncodableValue Insert(
       std::shared_ptr<sqflite_database::DatabaseManager> database,
-      std::string sql, sqflite_database::SQLParameters parameters,
+      const std::string &sql, const sqflite_database::SQLParameters &parameters,
       bool no_result) {
     database->Execute(sql, parameters);
     if (no_result) {
       return flutter::EncodableValue();
     }
+    return GetInsertResult(database);
+  }
 
+  static flutter::EncodableValue GetInsertResult(
+      std::shared_ptr<sqflite_database::DatabaseManager> database) {
     auto [changes, last_id] = QueryInsertChanges(database);
 
     if (changes == 0) {
@@ -303,61 +401,41 @@ class SqflitePlugin : public flutter::Plugin {
     return flutter::EncodableValue(last_id);
   }
 
-  flutter::EncodableValue Query(
+  static flutter::EncodableValue Query(
       std::shared_ptr<sqflite_database::DatabaseManager> database,
-      std::string sql, sqflite_database::SQLParameters parameters) {
-    auto db_result_visitor = DBResultVisitor{};
-    auto [columns, resultset] = database->Query(sql, parameters);
-    if (query_as_map_list_) {
-      flutter::EncodableList response;
-      if (resultset.size() == 0) {
-        return flutter::EncodableValue(response);
-      }
-      for (const auto &row : resultset) {
-        flutter::EncodableMap row_map;
-        for (size_t i = 0; i < row.size(); i++) {
-          auto row_value = std::visit(db_result_visitor, row[i]);
-          row_map.insert(
-              std::pair<flutter::EncodableValue, flutter::EncodableValue>(
-                  flutter::EncodableValue(columns[i]), row_value));
-        }
-        response.push_back(flutter::EncodableValue(row_map));
-      }
-      return flutter::EncodableValue(response);
-    } else {
-      flutter::EncodableMap response;
-      if (resultset.size() == 0) {
-        return flutter::EncodableValue(response);
-      }
-      flutter::EncodableList columns_response;
-      flutter::EncodableList rows_response;
-      for (const auto &column : columns) {
-        columns_response.push_back(flutter::EncodableValue(column));
-      }
-      for (const auto &row : resultset) {
-        flutter::EncodableList row_list;
-        for (const auto &column : row) {
-          auto row_value = std::visit(db_result_visitor, column);
-          row_list.push_back(row_value);
-        }
-        rows_response.push_back(flutter::EncodableValue(row_list));
-      }
-      response.insert(
-          std::pair<flutter::EncodableValue, flutter::EncodableValue>(
-              flutter::EncodableValue(sqflite_constants::kParamColumns),
-              flutter::EncodableValue(columns_response)));
-      response.insert(
-          std::pair<flutter::EncodableValue, flutter::EncodableValue>(
-              flutter::EncodableValue(sqflite_constants::kParamRows),
-              flutter::EncodableValue(rows_response)));
-      return flutter::EncodableValue(response);
+      const std::string &sql, const sqflite_database::SQLParameters &parameters,
+      bool query_as_map_list) {
+    return database->Query(sql, parameters, query_as_map_list);
+  }
+
+  static flutter::EncodableValue QueryCursor(
+      std::shared_ptr<sqflite_database::DatabaseManager> database,
+      const std::string &sql, const sqflite_database::SQLParameters &parameters,
+      int cursor_page_size) {
+    int cursor_id = database->QueryCursor(sql, parameters, cursor_page_size);
+    return QueryCursorNext(database, cursor_id);
+  }
+
+  // Cursor pages are always returned as columns and rows, with the id of the
+  // cursor attached as long as there are rows left to read.
+  static flutter::EncodableValue QueryCursorNext(
+      std::shared_ptr<sqflite_database::DatabaseManager> database,
+      int cursor_id) {
+    flutter::EncodableValue response = database->QueryCursorNext(cursor_id);
+    if (database->HasCursor(cursor_id)) {
+      std::get<flutter::EncodableMap>(response).insert(std::make_pair(
+          flutter::EncodableValue(sqflite_constants::kParamCursorId),
+          flutter::EncodableValue(cursor_id)));
+    } else if (sqflite_log_level::HasVerboseLevel(database->log_level())) {
+      LOG_DEBUG("Cursor %d closed", cursor_id);
     }
+    return response;
   }
 
   void OnInsertCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     int database_id;
     std::string sql;
@@ -380,20 +458,26 @@ class SqflitePlugin : public flutter::Plugin {
                         std::to_string(database_id));
       return;
     }
-    flutter::EncodableValue response;
-    try {
-      response = Insert(database, sql, parameters, no_result);
-    } catch (const sqflite_errors::DatabaseError &exception) {
-      HandleQueryException(exception, sql, parameters, std::move(result));
-      return;
-    }
-    result->Success(response);
+    SharedMethodResult shared_result = std::move(result);
+    auto worker = GetDatabaseWorker(database_id);
+    worker->Post([database, sql = std::move(sql),
+                  parameters = std::move(parameters), no_result,
+                  shared_result]() {
+      flutter::EncodableValue response;
+      try {
+        response = Insert(database, sql, parameters, no_result);
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        HandleQueryException(exception, sql, parameters, shared_result);
+        return;
+      }
+      ReplySuccess(shared_result, std::move(response));
+    });
   }
 
   void OnUpdateCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     int database_id;
     std::string sql;
@@ -416,20 +500,26 @@ class SqflitePlugin : public flutter::Plugin {
                         std::to_string(database_id));
       return;
     }
-    flutter::EncodableValue response;
-    try {
-      response = Update(database, sql, parameters, no_result);
-    } catch (const sqflite_errors::DatabaseError &exception) {
-      HandleQueryException(exception, sql, parameters, std::move(result));
-      return;
-    }
-    result->Success(response);
+    SharedMethodResult shared_result = std::move(result);
+    auto worker = GetDatabaseWorker(database_id);
+    worker->Post([database, sql = std::move(sql),
+                  parameters = std::move(parameters), no_result,
+                  shared_result]() {
+      flutter::EncodableValue response;
+      try {
+        response = Update(database, sql, parameters, no_result);
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        HandleQueryException(exception, sql, parameters, shared_result);
+        return;
+      }
+      ReplySuccess(shared_result, std::move(response));
+    });
   }
 
   void OnOptionsCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     bool parameters_as_list = false;
     int log_level = log_level_;
@@ -441,6 +531,56 @@ class SqflitePlugin : public flutter::Plugin {
 
     query_as_map_list_ = parameters_as_list;
     log_level_ = log_level;
+
+    int statement_cache_size = 0;
+    if (GetValueFromEncodableMap(arguments,
+                                 sqflite_constants::kParamStatementCacheSize,
+                                 statement_cache_size) &&
+        statement_cache_size > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      statement_cache_size_ = statement_cache_size;
+      for (const auto &[id, database] : database_map_) {
+        GetDatabaseWorker(id)->Post(
+            [database = database, statement_cache_size]() {
+              database->SetStatementCacheSize(statement_cache_size);
+            });
+      }
+      for (const auto &[id, readers] : database_readers_) {
+        readers->SetStatementCacheSize(statement_cache_size);
+      }
+    }
+
+    bool wal_mode = false;
+    if (GetValueFromEncodableMap(arguments, sqflite_constants::kParamWalMode,
+                                 wal_mode)) {
+      open_options_.wal_mode = wal_mode;
+    }
+    std::string synchronous;
+    if (GetValueFromEncodableMap(arguments,
+                                 sqflite_constants::kParamSynchronous,
+                                 synchronous)) {
+      std::transform(synchronous.begin(), synchronous.end(),
+                     synchronous.begin(), ::toupper);
+      if (synchronous != "OFF" && synchronous != "NORMAL" &&
+          synchronous != "FULL" && synchronous != "EXTRA") {
+        result->Error(sqflite_constants::kErrorBadParam,
+                      "Invalid synchronous mode " + synchronous);
+        return;
+      }
+      open_options_.synchronous = synchronous;
+    }
+    int64_t mmap_size = 0;
+    if (GetInt64FromEncodableMap(arguments, sqflite_constants::kParamMmapSize,
+                                 mmap_size)) {
+      open_options_.mmap_size = mmap_size;
+    }
+    int64_t cache_size = 0;
+    if (GetInt64FromEncodableMap(arguments, sqflite_constants::kParamCacheSize,
+                                 cache_size)) {
+      open_options_.cache_size = cache_size;
+    }
+    GetValueFromEncodableMap(arguments, sqflite_constants::kParamReaderCount,
+                             reader_count_);
     // TODO: Implement Thread Priority usage
     result->Success();
   }
@@ -448,16 +588,19 @@ class SqflitePlugin : public flutter::Plugin {
   void OnQueryCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     int database_id;
     std::string sql;
     sqflite_database::SQLParameters parameters;
+    int cursor_page_size = 0;
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamSqlArguments,
                              parameters);
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamSql, sql);
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamId,
                              database_id);
+    bool use_cursor = GetValueFromEncodableMap(
+        arguments, sqflite_constants::kParamCursorPageSize, cursor_page_size);
 
     std::lock_guard<std::mutex> lock(mutex_);
     auto database = GetDatabase(database_id);
@@ -467,14 +610,83 @@ class SqflitePlugin : public flutter::Plugin {
                         std::to_string(database_id));
       return;
     }
-    flutter::EncodableValue response;
-    try {
-      response = Query(database, sql, parameters);
-    } catch (const sqflite_errors::DatabaseError &exception) {
-      HandleQueryException(exception, sql, parameters, std::move(result));
+    SharedMethodResult shared_result = std::move(result);
+    bool query_as_map_list = query_as_map_list_;
+    auto task = [sql = std::move(sql), parameters = std::move(parameters),
+                 query_as_map_list, use_cursor, cursor_page_size,
+                 shared_result](
+                    std::shared_ptr<sqflite_database::DatabaseManager>
+                        database) {
+      flutter::EncodableValue response;
+      try {
+        if (use_cursor) {
+          response = QueryCursor(database, sql, parameters, cursor_page_size);
+        } else {
+          response = Query(database, sql, parameters, query_as_map_list);
+        }
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        HandleQueryException(exception, sql, parameters, shared_result);
+        return;
+      }
+      ReplySuccess(shared_result, std::move(response));
+    };
+
+    auto worker = GetDatabaseWorker(database_id);
+    auto readers = GetDatabaseReaders(database_id);
+    // A reader only sees committed data, so it is used when the writer has
+    // nothing pending and is not in a transaction. Checking the writer state
+    // is safe here because it is idle. The writer waits for the query before
+    // running any task posted after it, so a query never sees or overlaps a
+    // later write.
+    if (readers != nullptr && !use_cursor && worker->pending() == 0 &&
+        !database->InTransaction()) {
+      readers->Post(std::move(task));
+    } else {
+      worker->Post([database, task = std::move(task)]() { task(database); });
+    }
+  }
+
+  void OnQueryCursorNextCall(
+      const flutter::MethodCall<flutter::EncodableValue> &method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    const auto &arguments =
+        std::get<flutter::EncodableMap>(*method_call.arguments());
+    int database_id;
+    int cursor_id = 0;
+    bool cancel = false;
+    GetValueFromEncodableMap(arguments, sqflite_constants::kParamId,
+                             database_id);
+    GetValueFromEncodableMap(arguments, sqflite_constants::kParamCursorId,
+                             cursor_id);
+    GetValueFromEncodableMap(arguments, sqflite_constants::kParamCancel,
+                             cancel);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto database = GetDatabase(database_id);
+    if (database == nullptr) {
+      result->Error(sqflite_constants::kErrorDatabase,
+                    sqflite_constants::kErrorDatabaseClosed + " " +
+                        std::to_string(database_id));
       return;
     }
-    result->Success(response);
+    SharedMethodResult shared_result = std::move(result);
+    auto worker = GetDatabaseWorker(database_id);
+    worker->Post([database, cursor_id, cancel, shared_result]() {
+      if (cancel) {
+        database->CloseCursor(cursor_id);
+        ReplySuccess(shared_result);
+        return;
+      }
+      flutter::EncodableValue response;
+      try {
+        response = QueryCursorNext(database, cursor_id);
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        ReplyError(shared_result, sqflite_constants::kErrorDatabase,
+                   exception.what());
+        return;
+      }
+      ReplySuccess(shared_result, std::move(response));
+    });
   }
 
   void OnGetDatabasesPathCall(
@@ -494,7 +706,7 @@ class SqflitePlugin : public flutter::Plugin {
   void OnDeleteDatabase(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     std::string path;
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamPath, path);
@@ -503,11 +715,31 @@ class SqflitePlugin : public flutter::Plugin {
     auto existing_database_id = GetDatabaseId(path);
     if (existing_database_id) {
       if (IsDatabaseOpened(*existing_database_id)) {
-        database_map_.erase(*existing_database_id);
+        const int database_id = *existing_database_id;
+        auto database = GetDatabase(database_id);
+        auto worker = GetDatabaseWorker(database_id);
+        auto readers = GetDatabaseReaders(database_id);
+        database_map_.erase(database_id);
+        database_workers_.erase(database_id);
+        database_readers_.erase(database_id);
         single_instances_by_path_.erase(path);
         if (sqflite_log_level::HasVerboseLevel(log_level_)) {
           LOG_DEBUG("Deleting database in path %s", path.c_str());
         }
+        // Let pending tasks of the database complete before the file is
+        // removed.
+        SharedMethodResult shared_result = std::move(result);
+        worker->Post([database, readers = std::move(readers), path,
+                      shared_result]() mutable {
+          // Close the read connections before the writer.
+          readers.reset();
+          database.reset();
+          // Every connection to the file has been closed at this point, as
+          // the tasks posted before this one have released theirs.
+          std::filesystem::remove(path);
+          ReplySuccess(shared_result);
+        });
+        return;
       }
     }
     // TODO: Safe check before delete.
@@ -518,7 +750,7 @@ class SqflitePlugin : public flutter::Plugin {
   void OnDatabaseExistsCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     std::string path;
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamPath, path);
@@ -551,7 +783,7 @@ class SqflitePlugin : public flutter::Plugin {
   void OnOpenDatabaseCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     std::string path;
     bool read_only = false;
@@ -598,10 +830,11 @@ class SqflitePlugin : public flutter::Plugin {
       std::shared_ptr<sqflite_database::DatabaseManager> database_manager =
           std::make_shared<sqflite_database::DatabaseManager>(
               path, new_database_id, single_instance, log_level_);
+      database_manager->SetStatementCacheSize(statement_cache_size_);
       if (!read_only) {
-        database_manager->Open();
+        database_manager->Open(open_options_);
       } else {
-        database_manager->OpenReadOnly();
+        database_manager->OpenReadOnly(open_options_);
       }
 
       // Store dbid in internal map
@@ -609,6 +842,31 @@ class SqflitePlugin : public flutter::Plugin {
         single_instances_by_path_.insert(std::make_pair(path, new_database_id));
       }
       database_map_.insert(std::make_pair(new_database_id, database_manager));
+      auto worker = std::make_shared<sqflite_database::DatabaseWorker>();
+      database_workers_.insert(std::make_pair(new_database_id, worker));
+
+      if (!read_only && !in_memory && open_options_.wal_mode &&
+          reader_count_ > 0) {
+        try {
+          auto readers = std::make_shared<sqflite_database::ReadConnectionPool>(
+              path, new_database_id, log_level_, reader_count_,
+              statement_cache_size_, open_options_);
+          database_readers_.insert(std::make_pair(new_database_id, readers));
+          // Queries are only sent to the readers while the writer is idle,
+          // so every query running on a reader was posted before the next
+          // writer task, which must not start before the query is done.
+          worker->SetBeforeTask(
+              [weak_readers = std::weak_ptr<
+                   sqflite_database::ReadConnectionPool>(readers)]() {
+                if (auto readers = weak_readers.lock()) {
+                  readers->Wait();
+                }
+              });
+        } catch (const sqflite_errors::DatabaseError &exception) {
+          LOG_WARN("Failed to open readers of %s: %s", path.c_str(),
+                   exception.what());
+        }
+      }
     } catch (const sqflite_errors::DatabaseError &exception) {
       result->Error(sqflite_constants::kErrorDatabase,
                     sqflite_constants::kErrorOpenFailed + " " + path);
@@ -626,7 +884,7 @@ class SqflitePlugin : public flutter::Plugin {
   void OnCloseDatabaseCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     int database_id;
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamId,
@@ -643,30 +901,45 @@ class SqflitePlugin : public flutter::Plugin {
 
     auto path = database->path();
 
-    try {
-      // By erasing the entry from databaseMap, the destructor of
-      // database::DatabaseManager is called, which finalizes all open
-      // statements and closes the database.
-      if (sqflite_log_level::HasSqlLevel(database->log_level())) {
-        LOG_DEBUG("Closing database %d %s", database->database_id(),
-                  database->path().c_str());
-      }
-      database_map_.erase(database_id);
-
-      if (database->single_instance()) {
-        single_instances_by_path_.erase(path);
-      }
-    } catch (const sqflite_errors::DatabaseError &exception) {
-      LOG_ERROR("Error while closing database %d: %s", database_id,
-                exception.what());
-      result->Error(sqflite_constants::kErrorDatabase, exception.what());
-      return;
+    if (sqflite_log_level::HasSqlLevel(database->log_level())) {
+      LOG_DEBUG("Closing database %d %s", database->database_id(),
+                database->path().c_str());
+    }
+    auto worker = GetDatabaseWorker(database_id);
+    auto readers = GetDatabaseReaders(database_id);
+    database_map_.erase(database_id);
+    database_workers_.erase(database_id);
+    database_readers_.erase(database_id);
+
+    if (database->single_instance()) {
+      single_instances_by_path_.erase(path);
     }
 
-    result->Success();
+    // The worker keeps running until its pending tasks are done, so the
+    // database is closed after any statement queued before this call.
+    SharedMethodResult shared_result = std::move(result);
+    worker->Post([database, readers = std::move(readers), database_id,
+                  shared_result]() mutable {
+      try {
+        // The read connections are closed here rather than on the platform
+        // thread, as it waits for their running queries.
+        readers.reset();
+        // By releasing the last reference, the destructor of
+        // database::DatabaseManager is called, which finalizes all open
+        // statements and closes the database.
+        database.reset();
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        LOG_ERROR("Error while closing database %d: %s", database_id,
+                  exception.what());
+        ReplyError(shared_result, sqflite_constants::kErrorDatabase,
+                   exception.what());
+        return;
+      }
+      ReplySuccess(shared_result);
+    });
   };
 
-  flutter::EncodableValue BuildSuccessBatchOperationResult(
+  static flutter::EncodableValue BuildSuccessBatchOperationResult(
       flutter::EncodableValue result) {
     flutter::EncodableMap operation_result;
     operation_result.insert(std::make_pair(
@@ -674,9 +947,9 @@ class SqflitePlugin : public flutter::Plugin {
     return flutter::EncodableValue(operation_result);
   }
 
-  flutter::EncodableValue BuildErrorBatchOperationResult(
-      const sqflite_errors::DatabaseError &exception, std::string sql,
-      sqflite_database::SQLParameters parameters) {
+  static flutter::EncodableValue BuildErrorBatchOperationResult(
+      const sqflite_errors::DatabaseError &exception, const std::string &sql,
+      const sqflite_database::SQLParameters &parameters) {
     flutter::EncodableMap operation_result;
     flutter::EncodableMap operation_error_detail_result;
     flutter::EncodableMap operation_error_detail_data;
@@ -704,13 +977,12 @@ class SqflitePlugin : public flutter::Plugin {
   void OnBatchCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    flutter::EncodableMap arguments =
+    const auto &arguments =
         std::get<flutter::EncodableMap>(*method_call.arguments());
     int database_id;
     bool continue_on_error = false;
     bool no_result = false;
     flutter::EncodableList operations;
-    flutter::EncodableList results;
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamId,
                              database_id);
     GetValueFromEncodableMap(arguments, sqflite_constants::kParamOperations,
@@ -729,103 +1001,166 @@ class SqflitePlugin : public flutter::Plugin {
       return;
     }
 
+    SharedMethodResult shared_result = std::move(result);
+    bool query_as_map_list = query_as_map_list_;
+    auto worker = GetDatabaseWorker(database_id);
+    worker->Post([database, operations = std::move(operations),
+                  continue_on_error, no_result, query_as_map_list,
+                  shared_result]() {
+      RunBatch(database, operations, continue_on_error, no_result,
+               query_as_map_list, true, shared_result);
+    });
+  }
+
+  // Whether |operations| can be wrapped in a single transaction, which is not
+  // the case if they control transactions themselves or contain statements
+  // that cannot run inside a transaction.
+  static bool CanRunBatchInTransaction(
+      const flutter::EncodableList &operations) {
+    static const char *kStatementPrefixes[] = {
+        "BEGIN", "COMMIT", "END", "ROLLBACK", "SAVEPOINT", "RELEASE",
+        "VACUUM", "ATTACH", "DETACH", "PRAGMA"};
     for (const auto &item : operations) {
-      auto item_map = std::get<flutter::EncodableMap>(item);
-      std::string method;
-      std::string sql;
-      sqflite_database::SQLParameters parameters;
-      GetValueFromEncodableMap(item_map, sqflite_constants::kParamMethod,
-                               method);
-      GetValueFromEncodableMap(item_map, sqflite_constants::kParamSqlArguments,
-                               parameters);
-      GetValueFromEncodableMap(item_map, sqflite_constants::kParamSql, sql);
-
-      if (method == sqflite_constants::kMethodExecute) {
-        try {
-          Execute(database, sql, parameters);
-          if (!no_result) {
-            auto operation_result =
-                BuildSuccessBatchOperationResult(flutter::EncodableValue());
-            results.push_back(operation_result);
-          }
-        } catch (const sqflite_errors::DatabaseError &exception) {
-          if (!continue_on_error) {
-            HandleQueryException(exception, sql, parameters, std::move(result));
-            return;
-          } else {
-            if (!no_result) {
-              auto operation_result =
-                  BuildErrorBatchOperationResult(exception, sql, parameters);
-              results.push_back(operation_result);
-            }
-          }
+      const auto *sql = GetPointerFromEncodableMap<std::string>(
+          std::get<flutter::EncodableMap>(item), sqflite_constants::kParamSql);
+      if (sql == nullptr) {
+        continue;
+      }
+      size_t start = sql->find_first_not_of(" \t\r\n(");
+      if (start == std::string::npos) {
+        continue;
+      }
+      for (const char *prefix : kStatementPrefixes) {
+        size_t length = strlen(prefix);
+        if (sql->size() - start >= length &&
+            strncasecmp(sql->c_str() + start, prefix, length) == 0) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  static void RunBatch(
+      std::shared_ptr<sqflite_database::DatabaseManager> database,
+      const flutter::EncodableList &operations, bool continue_on_error,
+      bool no_result, bool query_as_map_list, bool allow_transaction,
+      SharedMethodResult result) {
+    static const std::string kEmptySql;
+    static const sqflite_database::SQLParameters kEmptyParameters;
+
+    // Commit once for the whole batch instead of once per operation, unless
+    // the caller already opened a transaction.
+    bool own_transaction = false;
+    if (allow_transaction && !database->InTransaction() &&
+        CanRunBatchInTransaction(operations)) {
+      try {
+        database->Execute("BEGIN");
+        own_transaction = true;
+      } catch (const sqflite_errors::DatabaseError &exception) {
+        ReplyError(result, sqflite_constants::kErrorDatabase, exception.what());
+        return;
+      }
+    }
+    // Operations which fail stop the batch, but the ones before them are kept
+    // as if they had been run without a transaction.
+    auto commit = [&database, &own_transaction]() {
+      if (own_transaction && database->InTransaction()) {
+        own_transaction = false;
+        database->Execute("COMMIT");
+      }
+    };
+
+    flutter::EncodableList results;
+    if (!no_result) {
+      results.reserve(operations.size());
+    }
+    // Consecutive operations with the same SQL reuse the prepared statement.
+    const std::string *prepared_sql = nullptr;
+    sqflite_database::DatabaseManager::Statement statement = nullptr;
+    try {
+      for (const auto &item : operations) {
+        const auto &item_map = std::get<flutter::EncodableMap>(item);
+        const auto *method = GetPointerFromEncodableMap<std::string>(
+            item_map, sqflite_constants::kParamMethod);
+        const auto *sql = GetPointerFromEncodableMap<std::string>(
+            item_map, sqflite_constants::kParamSql);
+        const auto *parameters =
+            GetPointerFromEncodableMap<sqflite_database::SQLParameters>(
+                item_map, sqflite_constants::kParamSqlArguments);
+        if (sql == nullptr) {
+          sql = &kEmptySql;
+        }
+        if (parameters == nullptr) {
+          parameters = &kEmptyParameters;
+        }
+        if (method == nullptr ||
+            (*method != sqflite_constants::kMethodExecute &&
+             *method != sqflite_constants::kMethodInsert &&
+             *method != sqflite_constants::kMethodQuery &&
+             *method != sqflite_constants::kMethodUpdate)) {
+          commit();
+          sqflite_database::RunOnMainThread(
+              [result]() { result->NotImplemented(); });
+          return;
         }
-      } else if (method == sqflite_constants::kMethodInsert) {
+
         try {
-          auto response = Insert(database, sql, parameters, no_result);
-          if (!no_result) {
-            auto operation_result = BuildSuccessBatchOperationResult(response);
-            results.push_back(operation_result);
+          if (prepared_sql == nullptr || *prepared_sql != *sql) {
+            prepared_sql = nullptr;
+            statement = database->Prepare(*sql);
+            prepared_sql = sql;
           }
-        } catch (const sqflite_errors::DatabaseError &exception) {
-          if (!continue_on_error) {
-            HandleQueryException(exception, sql, parameters, std::move(result));
-            return;
+          flutter::EncodableValue response;
+          if (*method == sqflite_constants::kMethodQuery && !no_result) {
+            response =
+                database->Query(statement, *parameters, query_as_map_list);
           } else {
-            if (!no_result) {
-              auto operation_result =
-                  BuildErrorBatchOperationResult(exception, sql, parameters);
-              results.push_back(operation_result);
+            database->Execute(statement, *parameters);
+            if (no_result) {
+              continue;
+            }
+            if (*method == sqflite_constants::kMethodInsert) {
+              response = GetInsertResult(database);
+            } else if (*method == sqflite_constants::kMethodUpdate) {
+              response = GetUpdateResult(database);
             }
           }
-        }
-      } else if (method == sqflite_constants::kMethodQuery) {
-        try {
-          auto response = Query(database, sql, parameters);
-          if (!no_result) {
-            auto operation_result = BuildSuccessBatchOperationResult(response);
-            results.push_back(operation_result);
-          }
+          results.push_back(BuildSuccessBatchOperationResult(response));
         } catch (const sqflite_errors::DatabaseError &exception) {
-          if (!continue_on_error) {
-            HandleQueryException(exception, sql, parameters, std::move(result));
+          prepared_sql = nullptr;
+          if (own_transaction && !database->InTransaction()) {
+            // The failure rolled back the whole transaction (for example
+            // with ON CONFLICT ROLLBACK), undoing the operations before it.
+            // Run the batch again one operation at a time, as it would run
+            // without a transaction.
+            RunBatch(database, operations, continue_on_error, no_result,
+                     query_as_map_list, false, result);
             return;
-          } else {
-            if (!no_result) {
-              auto operation_result =
-                  BuildErrorBatchOperationResult(exception, sql, parameters);
-              results.push_back(operation_result);
-            }
-          }
-        }
-      } else if (method == sqflite_constants::kMethodUpdate) {
-        try {
-          auto response = Update(database, sql, parameters, no_result);
-          if (!no_result) {
-            auto operation_result = BuildSuccessBatchOperationResult(response);
-            results.push_back(operation_result);
           }
-        } catch (const sqflite_errors::DatabaseError &exception) {
           if (!continue_on_error) {
-            HandleQueryException(exception, sql, parameters, std::move(result));
+            commit();
+            HandleQueryException(exception, *sql, *parameters, result);
             return;
           } else {
             if (!no_result) {
               auto operation_result =
-                  BuildErrorBatchOperationResult(exception, sql, parameters);
+                  BuildErrorBatchOperationResult(exception, *sql, *parameters);
               results.push_back(operation_result);
             }
           }
         }
-      } else {
-        result->NotImplemented();
-        return;
       }
+      commit();
+    } catch (const sqflite_errors::DatabaseError &exception) {
+      // The commit failed.
+      ReplyError(result, sqflite_constants::kErrorDatabase, exception.what());
+      return;
     }
     if (no_result) {
-      result->Success();
+      ReplySuccess(result);
     } else {
-      result->Success(flutter::EncodableValue(results));
+      ReplySuccess(result, flutter::EncodableValue(std::move(results)));
     }
   }
 
@@ -835,10 +1170,19 @@ class SqflitePlugin : public flutter::Plugin {
   inline static std::map<int,
                          std::shared_ptr<sqflite_database::DatabaseManager>>
       database_map_;
+  inline static std::map<int, std::shared_ptr<sqflite_database::DatabaseWorker>>
+      database_workers_;
+  inline static std::map<
+      int, std::shared_ptr<sqflite_database::ReadConnectionPool>>
+      database_readers_;
   inline static std::string databases_path_;
   inline static bool query_as_map_list_ = false;
   inline static int database_id_ = 0;  // incremental database id
   inline static int log_level_ = sqflite_log_level::kNone;
+  inline static int statement_cache_size_ =
+      sqflite_database::StatementCache::kDefaultCapacity;
+  inline static sqflite_database::OpenOptions open_options_;
+  inline static int reader_count_ = 0;
 };
 
 void SqflitePluginRegisterWithRegistrar(
@@ -0,0 +1,59 @@
+#include "statement_cache.h"
+
+namespace sqflite_database {
+
+StatementCache::~StatementCache() { Clear(); }
+
+sqlite3_stmt *StatementCache::Get(const std::string &sql) {
+  auto iter = index_.find(sql);
+  if (iter == index_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  return iter->second->second;
+}
+
+void StatementCache::Put(const std::string &sql, sqlite3_stmt *statement) {
+  auto iter = index_.find(sql);
+  if (iter != index_.end()) {
+    if (iter->second->second != statement) {
+      sqlite3_finalize(iter->second->second);
+      iter->second->second = statement;
+    }
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return;
+  }
+  entries_.emplace_front(sql, statement);
+  index_.emplace(entries_.front().first, entries_.begin());
+  size_ = entries_.size();
+  Evict();
+}
+
+void StatementCache::SetCapacity(size_t capacity) {
+  capacity_ = capacity > 0 ? capacity : 1;
+  Evict();
+}
+
+void StatementCache::Clear() {
+  for (auto &entry : entries_) {
+    sqlite3_finalize(entry.second);
+  }
+  index_.clear();
+  entries_.clear();
+  size_ = 0;
+}
+
+void StatementCache::Evict() {
+  while (entries_.size() > capacity_) {
+    Entry &entry = entries_.back();
+    sqlite3_finalize(entry.second);
+    index_.erase(entry.first);
+    entries_.pop_back();
+    evictions_++;
+  }
+  size_ = entries_.size();
+}
+
+}  // namespace sqflite_database
@@ -0,0 +1,62 @@
+#ifndef SQFLITE_STATEMENT_CACHE_H_
+#define SQFLITE_STATEMENT_CACHE_H_
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace sqflite_database {
+
+// A bounded least recently used cache of prepared statements keyed by their
+// SQL. Evicted statements are finalized.
+//
+// The cache itself is only used from the worker thread of its database, the
+// counters may be read from any thread.
+class StatementCache {
+ public:
+  static const size_t kDefaultCapacity = 100;
+
+  explicit StatementCache(size_t capacity = kDefaultCapacity)
+      : capacity_(capacity > 0 ? capacity : 1){};
+  ~StatementCache();
+
+  // Returns the statement prepared for |sql| or nullptr if not cached.
+  sqlite3_stmt *Get(const std::string &sql);
+  // Caches |statement|, which becomes the most recently used entry.
+  void Put(const std::string &sql, sqlite3_stmt *statement);
+  // Changes the capacity, evicting the least recently used statements if
+  // needed. The capacity is at least one, so that the statement in use is
+  // never evicted.
+  void SetCapacity(size_t capacity);
+  void Clear();
+
+  inline size_t size() const { return size_; };
+  inline size_t capacity() const { return capacity_; };
+  inline uint64_t hits() const { return hits_; };
+  inline uint64_t misses() const { return misses_; };
+  inline uint64_t evictions() const { return evictions_; };
+
+ private:
+  typedef std::pair<std::string, sqlite3_stmt *> Entry;
+
+  void Evict();
+
+  // Most recently used first. The index keys point into the SQL strings of
+  // the entries, which do not move while they are in the list.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+  std::atomic<size_t> size_ = 0;
+  std::atomic<size_t> capacity_;
+  std::atomic<uint64_t> hits_ = 0;
+  std::atomic<uint64_t> misses_ = 0;
+  std::atomic<uint64_t> evictions_ = 0;
+};
+
+}  // namespace sqflite_database
+#endif  // SQFLITE_STATEMENT_CACHE_H_
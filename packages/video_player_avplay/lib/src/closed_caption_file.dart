@@ -352,9 +352,11 @@ class PictureCaption extends Caption {
     this.picture,
     this.pictureWidth,
     this.pictureHeight,
+    this.pictureChannels,
   });
 
-  /// The image data for the caption, typically in a format like PNG or JPEG.
+  /// The image data for the caption, typically in a format like PNG or JPEG,
+  /// or raw pixels if [pictureChannels] is not null.
   final Uint8List? picture;
 
   /// Specifies the picture's width.
@@ -363,6 +365,12 @@ class PictureCaption extends Caption {
   /// Specifies the picture's height.
   final double? pictureHeight;
 
+  /// The number of channels of each pixel if [picture] holds raw pixels.
+  ///
+  /// Raw pixels are delivered instead of PNG data when the
+  /// `rawPictureSubtitle` player option is set.
+  final int? pictureChannels;
+
   /// A no picture caption object. This is a caption with [start] and [end] durations of zero,
   /// and an empty [picture].
   static const PictureCaption none = PictureCaption(
@@ -381,7 +389,8 @@ class PictureCaption extends Caption {
         'end: $end, '
         'picture: ${picture == null ? 'null' : '${picture?.length} bytes'}, '
         'pictureWidth: $pictureWidth, '
-        'pictureHeight: $pictureHeight)';
+        'pictureHeight: $pictureHeight, '
+        'pictureChannels: $pictureChannels)';
   }
 
   @override
@@ -394,11 +403,12 @@ class PictureCaption extends Caption {
           end == other.end &&
           picture == other.picture &&
           pictureWidth == other.pictureWidth &&
-          pictureHeight == other.pictureHeight;
+          pictureHeight == other.pictureHeight &&
+          pictureChannels == other.pictureChannels;
 
   @override
-  int get hashCode =>
-      Object.hash(number, start, end, picture, pictureWidth, pictureHeight);
+  int get hashCode => Object.hash(number, start, end, picture, pictureWidth,
+      pictureHeight, pictureChannels);
 }
 
 /// This attribute defines the upper-left corner of a rectangular region using [originX] and [originY] coordinate values
@@ -727,6 +737,7 @@ class Captions {
         picture: subtitlesInfo.pictureInfo!['picture'] as Uint8List?,
         pictureWidth: subtitlesInfo.pictureInfo!['pictureWidth'] as double?,
         pictureHeight: subtitlesInfo.pictureInfo!['pictureHeight'] as double?,
+        pictureChannels: subtitlesInfo.pictureInfo!['pictureChannels'] as int?,
       );
       return Captions(
           textCaptions: const <TextCaption>[TextCaption.none],
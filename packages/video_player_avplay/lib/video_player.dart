@@ -5,6 +5,7 @@
 
 import 'dart:async';
 import 'dart:io';
+import 'dart:ui' as ui;
 
 import 'package:device_info_plus_tizen/device_info_plus_tizen.dart';
 import 'package:flutter/foundation.dart';
@@ -1623,6 +1624,14 @@ class ClosedCaption extends StatelessWidget {
   Widget build(BuildContext context) {
     if (captions?.pictureCaption?.picture?.isNotEmpty ?? false) {
       final PictureCaption pictureCaption = captions!.pictureCaption!;
+      if (pictureCaption.pictureChannels != null) {
+        return Align(
+            alignment: Alignment.bottomCenter,
+            child: Padding(
+              padding: const EdgeInsets.only(bottom: 24.0),
+              child: _RawPictureCaption(pictureCaption: pictureCaption),
+            ));
+      }
       final Image subtitleImage = Image.memory(pictureCaption.picture!,
           width: pictureCaption.pictureWidth,
           height: pictureCaption.pictureHeight, errorBuilder:
@@ -1754,3 +1763,96 @@ class ClosedCaption extends StatelessWidget {
 /// with `!` and `?` on the stable branch.
 // TODO(ianh): Remove this once we roll stable in late 2021.
 T? _ambiguate<T>(T? value) => value;
+
+/// Displays a picture caption delivered as raw pixels, without decoding an
+/// encoded image.
+class _RawPictureCaption extends StatefulWidget {
+  const _RawPictureCaption({required this.pictureCaption});
+
+  final PictureCaption pictureCaption;
+
+  @override
+  State<_RawPictureCaption> createState() => _RawPictureCaptionState();
+}
+
+class _RawPictureCaptionState extends State<_RawPictureCaption> {
+  ui.Image? _image;
+
+  @override
+  void initState() {
+    super.initState();
+    _createImage();
+  }
+
+  @override
+  void didUpdateWidget(_RawPictureCaption oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (oldWidget.pictureCaption.picture != widget.pictureCaption.picture) {
+      _createImage();
+    }
+  }
+
+  @override
+  void dispose() {
+    _image?.dispose();
+    super.dispose();
+  }
+
+  void _createImage() {
+    final PictureCaption caption = widget.pictureCaption;
+    final Uint8List picture = caption.picture!;
+    final int width = caption.pictureWidth?.toInt() ?? 0;
+    final int height = caption.pictureHeight?.toInt() ?? 0;
+    if (width <= 0 || height <= 0) {
+      return;
+    }
+
+    void onImage(ui.Image image) {
+      if (!mounted || widget.pictureCaption.picture != picture) {
+        image.dispose();
+        return;
+      }
+      setState(() {
+        _image?.dispose();
+        _image = image;
+      });
+    }
+
+    final Uint8List pixels =
+        _toRgba(picture, caption.pictureChannels!, width * height);
+    ui.decodeImageFromPixels(
+        pixels, width, height, ui.PixelFormat.rgba8888, onImage);
+  }
+
+  static Uint8List _toRgba(Uint8List pixels, int channels, int count) {
+    if (channels == 4) {
+      return pixels;
+    }
+    final Uint8List rgba = Uint8List(count * 4);
+    for (int i = 0; i < count; i++) {
+      final int src = i * channels;
+      final int dst = i * 4;
+      if (channels == 3) {
+        rgba[dst] = pixels[src];
+        rgba[dst + 1] = pixels[src + 1];
+        rgba[dst + 2] = pixels[src + 2];
+        rgba[dst + 3] = 255;
+      } else {
+        rgba[dst] = pixels[src];
+        rgba[dst + 1] = pixels[src];
+        rgba[dst + 2] = pixels[src];
+        rgba[dst + 3] = channels == 2 ? pixels[src + 1] : 255;
+      }
+    }
+    return rgba;
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return RawImage(
+      image: _image,
+      width: widget.pictureCaption.pictureWidth,
+      height: widget.pictureCaption.pictureHeight,
+    );
+  }
+}
@@ -176,6 +176,9 @@ int64_t PlusPlayer::Create(const std::string &uri,
     is_prebuffer_mode_ = true;
   }
 
+  is_raw_picture_subtitle_ = flutter_common::GetValue(
+      create_message.player_options(), "rawPictureSubtitle", false);
+
   int64_t start_position = flutter_common::GetValue(
       create_message.player_options(), "startPosition", (int64_t)0);
   if (start_position > 0) {
@@ -1326,12 +1329,33 @@ void PlusPlayer::OnSubtitleData(char *data, const int size,
         "[PlusPlayer] Subtitle is a picture: size: %d, width: %f, height: %f",
         size, picture_width, picture_height);
 
-    int subtitle_mem_length = 0;
     int channels = size / area;
     if (channels < 1 || channels > 4) {
       LOG_ERROR("[PlusPlayer] Invalid number of channels: %d", channels);
       return;
     }
+
+    if (self->is_raw_picture_subtitle_) {
+      // Pass the pixels as they are, so that neither side has to encode or
+      // decode an image.
+      const uint8_t *pixels = reinterpret_cast<const uint8_t *>(data);
+      flutter::EncodableMap picture_info = {
+          {flutter::EncodableValue("pictureWidth"),
+           flutter::EncodableValue(picture_width)},
+          {flutter::EncodableValue("pictureHeight"),
+           flutter::EncodableValue(picture_height)},
+          {flutter::EncodableValue("pictureChannels"),
+           flutter::EncodableValue(channels)},
+      };
+      picture_info[flutter::EncodableValue("picture")] =
+          flutter::EncodableValue(std::vector<uint8_t>(
+              pixels, pixels + static_cast<size_t>(area) * channels));
+      self->SendSubtitleUpdate(duration, flutter::EncodableList(),
+                               std::move(picture_info));
+      return;
+    }
+
+    int subtitle_mem_length = 0;
     int stride_in_bytes = static_cast<int>(picture_width) * channels;
 
     unsigned char *subtitle_png = stbi_write_png_to_mem(
@@ -1342,17 +1366,17 @@ void PlusPlayer::OnSubtitleData(char *data, const int size,
     if (subtitle_png && subtitle_mem_length > 0) {
       std::vector<uint8_t> picture(subtitle_png,
                                    subtitle_png + subtitle_mem_length);
+      STBIW_FREE(subtitle_png);
       flutter::EncodableMap picture_info = {
-          {flutter::EncodableValue("picture"),
-           flutter::EncodableValue(picture)},
           {flutter::EncodableValue("pictureWidth"),
            flutter::EncodableValue(picture_width)},
           {flutter::EncodableValue("pictureHeight"),
            flutter::EncodableValue(picture_height)},
       };
+      picture_info[flutter::EncodableValue("picture")] =
+          flutter::EncodableValue(std::move(picture));
       self->SendSubtitleUpdate(duration, flutter::EncodableList(),
-                               picture_info);
-      STBIW_FREE(subtitle_png);
+                               std::move(picture_info));
     } else {
       LOG_ERROR("[PlusPlayer] Picture subtitle data is null or size is 0.");
     }
@@ -1371,7 +1395,7 @@ void PlusPlayer::OnSubtitleData(char *data, const int size,
       texts_info.emplace_back(flutter::EncodableValue(text_line));
     }
 
-    self->SendSubtitleUpdate(duration, texts_info);
+    self->SendSubtitleUpdate(duration, std::move(texts_info));
   }
 }
 
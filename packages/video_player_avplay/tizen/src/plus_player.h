@@ -108,6 +108,7 @@ class PlusPlayer : public VideoPlayer {
   std::unique_ptr<DrmManager> drm_manager_;
   bool is_buffering_ = false;
   bool is_prebuffer_mode_ = false;
+  bool is_raw_picture_subtitle_ = false;
   SeekCompletedCallback on_seek_completed_;
   std::unique_ptr<plusplayer::PlayerMemento> memento_ = nullptr;
   std::string url_;
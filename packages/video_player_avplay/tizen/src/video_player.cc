@@ -96,7 +96,7 @@ void VideoPlayer::PushEvent(flutter::EncodableValue encodable_value) {
     LOG_ERROR("[VideoPlayer] event sink is nullptr.");
     return;
   }
-  encodable_event_queue_.push(encodable_value);
+  encodable_event_queue_.push(std::move(encodable_value));
   ecore_pipe_write(sink_event_pipe_, nullptr, 0);
 }
 
@@ -154,13 +154,14 @@ void VideoPlayer::SendSubtitleUpdate(int32_t duration,
       {flutter::EncodableValue("event"),
        flutter::EncodableValue("subtitleUpdate")},
       {flutter::EncodableValue("duration"), flutter::EncodableValue(duration)},
-      {flutter::EncodableValue("textsInfo"),
-       flutter::EncodableValue(texts_info)},
-      {flutter::EncodableValue("pictureInfo"),
-       flutter::EncodableValue(picture_info)},
   };
+  // Move the subtitle data, which can hold a whole picture.
+  result[flutter::EncodableValue("textsInfo")] =
+      flutter::EncodableValue(std::move(texts_info));
+  result[flutter::EncodableValue("pictureInfo")] =
+      flutter::EncodableValue(std::move(picture_info));
 
-  PushEvent(flutter::EncodableValue(result));
+  PushEvent(flutter::EncodableValue(std::move(result)));
 }
 
 void VideoPlayer::SendPlayCompleted() {
@@ -249,4 +249,18 @@ class TizenWebView {
   /// Whether the horizontal scrollbar should be drawn or not.
   Future<void> setHorizontalScrollBarEnabled(bool enabled) =>
       _invokeChannelMethod<void>('setHorizontalScrollBarEnabled', enabled);
+
+  /// Returns the counters of the surface pool this WebView renders into.
+  ///
+  /// The pool adapts its size between `minSize` and `maxSize` based on how
+  /// often it runs out of surfaces (`exhausted`) and how long the engine holds
+  /// a surface (`releaseLatencyUs`) compared with the interval between frames
+  /// (`acquireIntervalUs`).
+  Future<Map<String, Object?>> getBufferPoolMetrics() async {
+    final Map<Object?, Object?>? metrics =
+        await _invokeChannelMethod<Map<Object?, Object?>>(
+          'getBufferPoolMetrics',
+        );
+    return metrics?.cast<String, Object?>() ?? <String, Object?>{};
+  }
 }
@@ -355,6 +355,11 @@ class TizenWebViewController extends PlatformWebViewController {
   @override
   bool supportsSetScrollBarsEnabled() => true;
 
+  /// Returns the counters of the surface pool this WebView renders into, for
+  /// tuning purposes.
+  Future<Map<String, Object?>> getBufferPoolMetrics() =>
+      _webview.getBufferPoolMetrics();
+
   @override
   Future<void> setOverScrollMode(WebViewOverScrollMode mode) async {
     throw UnimplementedError(
@@ -16,7 +16,10 @@
 
 namespace {
 
-constexpr size_t kBufferPoolSize = 5;
+// The pool grows up to the maximum while the engine holds units longer than
+// the interval between frames.
+constexpr size_t kMinBufferPoolSize = 1;
+constexpr size_t kMaxBufferPoolSize = 3;
 constexpr char kEwkInstance[] = "ewk_instance";
 constexpr char kTizenWebViewChannelName[] = "plugins.flutter.io/tizen_webview_";
 constexpr char kTizenWebViewControllerChannelName[] =
@@ -103,7 +106,10 @@ WebView::WebView(flutter::PluginRegistrar* registrar, int view_id,
     return;
   }
 
-  tbm_pool_ = std::make_unique<SingleBufferPool>(width, height);
+  // The units refer to the surfaces rendered by the engine.
+  tbm_pool_ = std::make_unique<BufferPool>(width, height, kMinBufferPoolSize,
+                                           kMaxBufferPoolSize,
+                                           TBM_FORMAT_ARGB8888, true);
 
   texture_variant_ =
       std::make_unique<flutter::TextureVariant>(flutter::GpuSurfaceTexture(
@@ -215,6 +221,7 @@ void WebView::Resize(double width, double height) {
   height_ = height;
 
   if (candidate_surface_) {
+    tbm_pool_->Release(candidate_surface_);
     candidate_surface_ = nullptr;
   }
 
@@ -712,6 +719,9 @@ void WebView::HandleWebViewMethodCall(const FlMethodCall& method_call,
     } else {
       result->Error("Invalid argument", "The argument must be a bool.");
     }
+  } else if (method_name == "getBufferPoolMetrics") {
+    result->Success(
+        flutter::EncodableValue(tbm_pool_->GetMetrics().ToEncodableMap()));
   } else {
     result->NotImplemented();
   }
@@ -745,17 +755,18 @@ void WebView::HandleCookieMethodCall(const FlMethodCall& method_call,
 FlutterDesktopGpuSurfaceDescriptor* WebView::ObtainGpuSurface(size_t width,
                                                               size_t height) {
   std::lock_guard<std::mutex> lock(mutex_);
-  if (!candidate_surface_) {
+  if (candidate_surface_) {
+    // The rendered surface stays in use while it is displayed, and goes back
+    // to the pool when the engine releases its last descriptor.
     if (rendered_surface_) {
-      return rendered_surface_->GpuSurface();
+      tbm_pool_->Release(rendered_surface_);
     }
-    return nullptr;
+    rendered_surface_ = candidate_surface_;
+    candidate_surface_ = nullptr;
   }
-  if (rendered_surface_ && rendered_surface_->IsUsed()) {
-    tbm_pool_->Release(rendered_surface_);
+  if (!rendered_surface_) {
+    return nullptr;
   }
-  rendered_surface_ = candidate_surface_;
-  candidate_surface_ = nullptr;
   return rendered_surface_->GpuSurface();
 }
 
@@ -766,7 +777,9 @@ void WebView::OnFrameRendered(void* data, Evas_Object* obj, void* event_info) {
     std::lock_guard<std::mutex> lock(webview->mutex_);
     if (!webview->working_surface_) {
       webview->working_surface_ = webview->tbm_pool_->GetAvailableBuffer();
-      webview->working_surface_->UseExternalBuffer();
+      if (!webview->working_surface_) {
+        return;
+      }
     }
     webview->working_surface_->SetExternalBuffer(
         static_cast<tbm_surface_h>(event_info));
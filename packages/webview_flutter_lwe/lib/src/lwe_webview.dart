@@ -239,4 +239,32 @@ class LweWebView {
   /// Whether the horizontal scrollbar should be drawn or not.
   Future<void> setHorizontalScrollBarEnabled(bool enabled) =>
       _invokeChannelMethod<void>('setHorizontalScrollBarEnabled', enabled);
+
+  /// Returns the counters of the surface pool this WebView renders into.
+  ///
+  /// The pool adapts its size between `minSize` and `maxSize` based on how
+  /// often it runs out of surfaces (`exhausted`) and how long the engine holds
+  /// a surface (`releaseLatencyUs`) compared with the interval between frames
+  /// (`acquireIntervalUs`).
+  Future<Map<String, Object?>> getBufferPoolMetrics() async {
+    final Map<Object?, Object?>? metrics =
+        await _invokeChannelMethod<Map<Object?, Object?>>(
+          'getBufferPoolMetrics',
+        );
+    return metrics?.cast<String, Object?>() ?? <String, Object?>{};
+  }
+
+  /// Returns the counters of the queue that delivers engine callbacks to the
+  /// main thread.
+  ///
+  /// `queued` and `drained` count the callbacks, `batches` counts the main
+  /// loop wakeups that delivered them and `maxLatencyUs` is the longest time a
+  /// callback has waited in the queue.
+  Future<Map<String, Object?>> getMessageDispatcherStats() async {
+    final Map<Object?, Object?>? stats =
+        await _invokeChannelMethod<Map<Object?, Object?>>(
+          'getMessageDispatcherStats',
+        );
+    return stats?.cast<String, Object?>() ?? <String, Object?>{};
+  }
 }
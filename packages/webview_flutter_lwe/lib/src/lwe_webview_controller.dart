@@ -247,6 +247,16 @@ class LweWebViewController extends PlatformWebViewController {
   @override
   bool supportsSetScrollBarsEnabled() => true;
 
+  /// Returns the counters of the surface pool this WebView renders into, for
+  /// tuning purposes.
+  Future<Map<String, Object?>> getBufferPoolMetrics() =>
+      _webview.getBufferPoolMetrics();
+
+  /// Returns the counters of the queue that delivers engine callbacks to the
+  /// main thread, for tuning purposes.
+  Future<Map<String, Object?>> getMessageDispatcherStats() =>
+      _webview.getMessageDispatcherStats();
+
   @override
   Future<void> setOverScrollMode(WebViewOverScrollMode mode) async {
     throw UnimplementedError(
@@ -4,28 +4,112 @@
 
 #include "message_dispatcher.h"
 
-#include <Ecore.h>
+#include <glib.h>
 
-MessageDispatcher::MessageDispatcher() { ecore_init(); }
-MessageDispatcher::~MessageDispatcher() { ecore_shutdown(); }
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+struct Task {
+  std::function<void()> fn;
+  int64_t queued_us;
+  Task* next;
+};
+
+int64_t NowMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+// A lock-free multi-producer single-consumer queue. Producers push onto an
+// intrusive stack, and the main thread takes the whole stack at once and
+// reverses it to restore the order.
+struct MessageDispatcher::TaskQueue {
+  std::atomic<Task*> head = nullptr;
+  std::atomic_bool closed = false;
+  std::atomic<uint64_t> queued = 0;
+  std::atomic<uint64_t> drained = 0;
+  std::atomic<uint64_t> batches = 0;
+  std::atomic<int64_t> max_latency_us = 0;
+
+  // Takes the queued tasks in the order they were pushed.
+  Task* TakeAll() {
+    Task* task = head.exchange(nullptr, std::memory_order_acquire);
+    Task* reversed = nullptr;
+    while (task) {
+      Task* next = task->next;
+      task->next = reversed;
+      reversed = task;
+      task = next;
+    }
+    return reversed;
+  }
+
+  void Drain() {
+    Task* task = TakeAll();
+    if (!task) {
+      return;
+    }
+    int64_t now = NowMicroseconds();
+    int64_t max_latency = max_latency_us.load();
+    while (task) {
+      max_latency = std::max(max_latency, now - task->queued_us);
+      if (!closed.load()) {
+        task->fn();
+      }
+      Task* next = task->next;
+      delete task;
+      task = next;
+      drained++;
+    }
+    max_latency_us.store(max_latency);
+    batches++;
+  }
+};
+
+MessageDispatcher::MessageDispatcher()
+    : queue_(std::make_shared<TaskQueue>()) {}
+
+MessageDispatcher::~MessageDispatcher() {
+  queue_->closed.store(true);
+  queue_->Drain();
+}
 
 void MessageDispatcher::dispatchTaskOnMainThread(std::function<void()>&& fn) {
-  struct Param {
-    std::function<void()> fn;
-  };
-  Param* p = new Param({std::move(fn)});
-
-  ecore_main_loop_thread_safe_call_async(
-      [](void* data) -> void {
-        ecore_timer_add(
-            0.0,
-            [](void* data) -> Eina_Bool {
-              auto* p = static_cast<Param*>(data);
-              p->fn();
-              delete p;
-              return ECORE_CALLBACK_CANCEL;
-            },
-            data);
-      },
-      p);
+  Task* task = new Task{std::move(fn), NowMicroseconds(), nullptr};
+  Task* head = queue_->head.load(std::memory_order_relaxed);
+  do {
+    task->next = head;
+  } while (!queue_->head.compare_exchange_weak(
+      head, task, std::memory_order_release, std::memory_order_relaxed));
+  queue_->queued++;
+
+  // Only the task that finds the queue empty wakes up the main loop. The
+  // others are drained in the same wakeup.
+  if (!head) {
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT,
+        [](gpointer data) -> gboolean {
+          static_cast<std::shared_ptr<TaskQueue>*>(data)->get()->Drain();
+          return G_SOURCE_REMOVE;
+        },
+        new std::shared_ptr<TaskQueue>(queue_),
+        [](gpointer data) {
+          delete static_cast<std::shared_ptr<TaskQueue>*>(data);
+        });
+  }
+}
+
+MessageDispatcherStats MessageDispatcher::GetStats() const {
+  MessageDispatcherStats stats;
+  stats.queued = queue_->queued.load();
+  stats.drained = queue_->drained.load();
+  stats.batches = queue_->batches.load();
+  stats.max_latency_us = queue_->max_latency_us.load();
+  return stats;
 }
@@ -5,14 +5,39 @@
 #ifndef FLUTTER_PLUGIN_MESSAGE_DISPATCHER_H_
 #define FLUTTER_PLUGIN_MESSAGE_DISPATCHER_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+
+struct MessageDispatcherStats {
+  // The number of tasks dispatched and the number of tasks run or dropped.
+  uint64_t queued = 0;
+  uint64_t drained = 0;
+  // The number of main loop wakeups that drained the queue.
+  uint64_t batches = 0;
+  // The longest time a task has waited in the queue, in microseconds.
+  int64_t max_latency_us = 0;
+};
 
 class MessageDispatcher {
  public:
   MessageDispatcher();
   ~MessageDispatcher();
 
+  // Queues |fn| to be run on the main thread. This can be called from any
+  // thread. Tasks queued before the main loop wakes up are run in order in a
+  // single wakeup. Tasks still queued when the dispatcher is destroyed are
+  // dropped.
   void dispatchTaskOnMainThread(std::function<void()>&& fn);
+
+  MessageDispatcherStats GetStats() const;
+
+ private:
+  struct TaskQueue;
+
+  // Shared with the pending main loop source, which may outlive the
+  // dispatcher.
+  std::shared_ptr<TaskQueue> queue_;
 };
 
 #endif  // FLUTTER_PLUGIN_MESSAGE_DISPATCHER_H_
@@ -7,6 +7,7 @@
 #include <app_common.h>
 #include <flutter/standard_method_codec.h>
 #include <flutter_texture_registrar.h>
+#include <glib.h>
 #include <system_info.h>
 #include <tbm_surface.h>
 
@@ -21,7 +22,13 @@
 
 namespace {
 
-constexpr size_t kBufferPoolSize = 5;
+// The pool grows up to the maximum while the engine holds units longer than
+// the interval between frames.
+constexpr size_t kMinBufferPoolSize = 2;
+constexpr size_t kMaxBufferPoolSize = 5;
+// Resizes that follow each other within this interval, e.g. during a resize
+// animation, are applied once they settle.
+constexpr guint kResizeDebounceMs = 100;
 constexpr char kLweWebViewChannelName[] = "plugins.flutter.io/lwe_webview_";
 constexpr char kLweNavigationDelegateChannelName[] =
     "plugins.flutter.io/lwe_webview_navigation_delegate_";
@@ -106,12 +113,16 @@ WebView::WebView(flutter::PluginRegistrar* registrar, int view_id,
     : PlatformView(registrar, view_id, nullptr),
       texture_registrar_(texture_registrar),
       width_(width),
-      height_(height) {
+      height_(height),
+      surface_width_(width),
+      surface_height_(height) {
   use_sw_backend_ = IsRunningOnEmulator();
   if (use_sw_backend_) {
     tbm_pool_ = std::make_unique<SingleBufferPool>(width, height);
   } else {
-    tbm_pool_ = std::make_unique<BufferPool>(width, height, kBufferPoolSize);
+    tbm_pool_ = std::make_unique<BufferPool>(width, height, kMinBufferPoolSize,
+                                             kMaxBufferPoolSize,
+                                             TBM_FORMAT_ARGB8888);
   }
 
   texture_variant_ =
@@ -257,6 +268,10 @@ std::string WebView::GetNavigationDelegateChannelName() {
 }
 
 void WebView::Dispose() {
+  if (resize_timer_id_) {
+    g_source_remove(resize_timer_id_);
+    resize_timer_id_ = 0;
+  }
   texture_registrar_->UnregisterTexture(GetTextureId(), nullptr);
 
   if (webview_instance_) {
@@ -269,11 +284,43 @@ void WebView::Resize(double width, double height) {
   width_ = width;
   height_ = height;
 
-  if (candidate_surface_) {
-    candidate_surface_ = nullptr;
+  // The first resize is applied at once, and the ones that follow it are
+  // coalesced until no resize has come for kResizeDebounceMs.
+  if (resize_timer_id_) {
+    g_source_remove(resize_timer_id_);
+  } else {
+    ApplyResize();
   }
+  resize_timer_id_ = g_timeout_add(
+      kResizeDebounceMs,
+      [](gpointer data) -> gboolean {
+        auto* self = static_cast<WebView*>(data);
+        self->resize_timer_id_ = 0;
+        self->ApplyResize();
+        return G_SOURCE_REMOVE;
+      },
+      this);
+}
+
+void WebView::ApplyResize() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int32_t width = static_cast<int32_t>(width_);
+    int32_t height = static_cast<int32_t>(height_);
+    if (surface_width_ == width && surface_height_ == height) {
+      return;
+    }
+    surface_width_ = width;
+    surface_height_ = height;
 
-  tbm_pool_->Prepare(width_, height_);
+    if (candidate_surface_) {
+      tbm_pool_->Release(candidate_surface_);
+      candidate_surface_ = nullptr;
+    }
+  }
+  // Surfaces are not reallocated here. Each one is resized when it is next
+  // acquired, so the surface held by the engine stays valid and a resize
+  // costs at most one allocation per rendered frame.
   webview_instance_->ResizeTo(width_, height_);
 }
 
@@ -552,7 +599,8 @@ void WebView::InitWebView() {
     std::lock_guard<std::mutex> lock(mutex_);
     LWE::WebContainer::ExternalImageInfo result;
     if (!working_surface_) {
-      working_surface_ = tbm_pool_->GetAvailableBuffer();
+      working_surface_ =
+          tbm_pool_->GetAvailableBuffer(surface_width_, surface_height_);
     }
     if (working_surface_) {
       result.imageAddress = working_surface_->Surface();
@@ -775,6 +823,22 @@ void WebView::HandleWebViewMethodCall(const FlMethodCall& method_call,
       webview_instance_->SetSettings(settings);
     }
     result->Success();
+  } else if (method_name == "getBufferPoolMetrics") {
+    result->Success(
+        flutter::EncodableValue(tbm_pool_->GetMetrics().ToEncodableMap()));
+  } else if (method_name == "getMessageDispatcherStats") {
+    MessageDispatcherStats stats = dispatcher_->GetStats();
+    flutter::EncodableMap map = {
+        {flutter::EncodableValue("queued"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.queued))},
+        {flutter::EncodableValue("drained"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.drained))},
+        {flutter::EncodableValue("batches"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.batches))},
+        {flutter::EncodableValue("maxLatencyUs"),
+         flutter::EncodableValue(stats.max_latency_us)},
+    };
+    result->Success(flutter::EncodableValue(map));
   } else {
     result->NotImplemented();
   }
@@ -802,16 +866,25 @@ void WebView::HandleCookieMethodCall(const FlMethodCall& method_call,
 FlutterDesktopGpuSurfaceDescriptor* WebView::ObtainGpuSurface(size_t width,
                                                               size_t height) {
   std::lock_guard<std::mutex> lock(mutex_);
-  if (!candidate_surface_) {
-    if (rendered_surface_) {
-      return rendered_surface_->GpuSurface();
+  if (candidate_surface_) {
+    // The rendered surface stays in use while it is displayed, and goes back
+    // to the pool when the engine releases its last descriptor.
+    if (rendered_surface_ && !use_sw_backend_) {
+      tbm_pool_->Release(rendered_surface_);
+    }
+    rendered_surface_ = candidate_surface_;
+    candidate_surface_ = nullptr;
+    if (use_sw_backend_) {
+      // The only surface of the software backend cannot stay in use, or
+      // nothing could be rendered into it anymore.
+      FlutterDesktopGpuSurfaceDescriptor* descriptor =
+          rendered_surface_->GpuSurface();
+      tbm_pool_->Release(rendered_surface_);
+      return descriptor;
     }
-    return nullptr;
   }
-  if (rendered_surface_ && rendered_surface_->IsUsed()) {
-    tbm_pool_->Release(rendered_surface_);
+  if (!rendered_surface_) {
+    return nullptr;
   }
-  rendered_surface_ = candidate_surface_;
-  candidate_surface_ = nullptr;
   return rendered_surface_->GpuSurface();
 }
@@ -11,6 +11,7 @@
 #include <flutter/standard_message_codec.h>
 #include <flutter/texture_registrar.h>
 #include <flutter_platform_view.h>
+#include <glib.h>
 
 #include <cstddef>
 #include <memory>
@@ -70,11 +71,16 @@ class WebView : public PlatformView {
   std::string GetNavigationDelegateChannelName();
 
   void InitWebView();
+  void ApplyResize();
 
   LWE::WebContainer* webview_instance_ = nullptr;
   flutter::TextureRegistrar* texture_registrar_;
   double width_;
   double height_;
+  // The size that the web engine renders at, guarded by |mutex_|.
+  int32_t surface_width_;
+  int32_t surface_height_;
+  guint resize_timer_id_ = 0;
   BufferUnit* working_surface_ = nullptr;
   BufferUnit* candidate_surface_ = nullptr;
   BufferUnit* rendered_surface_ = nullptr;
@@ -0,0 +1,40 @@
+#!/bin/bash
+# Copyright 2026 Samsung Electronics Co., Ltd. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+# Fails if the copies of a source file shared by several plugins differ.
+
+set -e
+
+readonly SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" >/dev/null && pwd)"
+readonly REPO_DIR="$(dirname "$SCRIPT_DIR")"
+
+# Each group lists the copies of one file, the first being the reference.
+readonly SHARED_SOURCES=(
+  "packages/webview_flutter/tizen/src/buffer_pool.h
+   packages/webview_flutter_lwe/tizen/src/buffer_pool.h
+   packages/flutter_inappwebview/tizen/src/buffer_pool.h
+   packages/flutter_webrtc/tizen/inc/buffer_pool.h"
+  "packages/webview_flutter/tizen/src/buffer_pool.cc
+   packages/webview_flutter_lwe/tizen/src/buffer_pool.cc
+   packages/flutter_inappwebview/tizen/src/buffer_pool.cc
+   packages/flutter_webrtc/tizen/src/buffer_pool.cc"
+)
+
+cd "$REPO_DIR"
+failed=0
+for group in "${SHARED_SOURCES[@]}"; do
+  files=($group)
+  for file in "${files[@]:1}"; do
+    if ! cmp -s "${files[0]}" "$file"; then
+      echo "$file differs from ${files[0]}."
+      failed=1
+    fi
+  done
+done
+
+if [[ "$failed" != 0 ]]; then
+  echo "Shared sources must be kept identical."
+  exit 1
+fi